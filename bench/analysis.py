@@ -0,0 +1,61 @@
+# semantic analysis time on many functions of long expressions, with inferred return types, inferred locals and globals
+# 	SemanticAnalyzer is what to compare (the other phases grow with the file too)
+#
+# usage: python3 bench/analysis.py path/to/hawk [path/to/other/hawk ...] [-functions=N] [-terms=N] [-runs=N]
+
+import sys
+
+import timing
+
+
+
+GLOBALS = 8
+
+
+def expression(rng, terms, names):
+	parts = [rng.choice(names)]
+	for _ in range(terms - 1):
+		operand = rng.choice(names) if rng.randrange(3) != 0 else str(rng.randrange(100))
+		parts.append(f"{rng.choice(['+', '-', '*'])} {operand}")
+	return " ".join(parts)
+
+
+def function(rng, index, terms):
+	# half of them leave their return type to be inferred
+	return_type = " int" if rng.randrange(2) == 0 else ""
+	lines = [f"func analysis_{index}(a: int, b: int){return_type} {{", "\ts : int = a + b;"]
+
+	names = ["a", "b", "s"] + [f"g{i}" for i in range(GLOBALS)]
+
+	# a call to a function before it, its type is what that one returns
+	if index > 0:
+		lines.append(f"\tc := analysis_{rng.randrange(index)}(a, {rng.randrange(10)});")
+		names.append("c")
+
+	lines.append(f"\ts = {expression(rng, terms, names)};")
+	lines.append(f"\tif (s > {expression(rng, terms // 4, names)}) {{")
+	lines.append(f"\t\td : int = {expression(rng, terms, names)};")
+	lines.append(f"\t\ts = {expression(rng, terms, names + ['d'])};")
+	lines.append("\t} else {")
+	lines.append(f"\t\ts = {expression(rng, terms, names)};")
+	lines.append("\t};")
+	lines += ["\treturn s;", "};", ""]
+	return "\n".join(lines) + "\n"
+
+
+def make_source(rng, options):
+	parts = [f"g{i} : int = {rng.randrange(100)};\n" for i in range(GLOBALS)]
+	parts.append("\n")
+	parts += [function(rng, index, options["terms"]) for index in range(options["functions"])]
+
+	parts.append(f"func main() int {{\n\tt : int = 0;\n\tanalysis_{options['functions'] - 1}(t, 1);\n\treturn t;\n}};\n")
+	return "".join(parts)
+
+
+
+if __name__ == "__main__":
+	sys.exit(timing.main(
+		"usage: python3 bench/analysis.py path/to/hawk [path/to/other/hawk ...] [-functions=N] [-terms=N] [-runs=N]",
+		{"functions": 3000, "terms": 40, "runs": 15},
+		make_source,
+	))
@@ -0,0 +1,63 @@
+# lexer speed (MB/s) on a big generated file of functions, literals and comments
+# 	the Tokenizer phase is what to compare (the whole run also parses, analyzes and builds the IR)
+# 	(it stays away from what older builds got wrong: 'x' in names, '||', '/**', '&&' and bool variables)
+#
+# usage: python3 bench/lexer.py path/to/hawk [path/to/other/hawk ...] [-size=MB] [-runs=N]
+
+import sys
+
+import timing
+
+
+
+COMMENTS = [
+	"\t// a line comment, with some words and 123 numbers in it\n",
+	"\t/* a block comment */\n",
+	"\t/* a block comment\n\t   over a few lines\n\t   of text */\n",
+	"\t/* nested /* block */ comment */\n",
+	"",
+	"",
+]
+
+
+def function(rng, index):
+	lines = [f"func function_{index}(alpha: int, beta: int) int {{"]
+	lines.append(rng.choice(COMMENTS) + "\ttotal : int = alpha + beta;")
+	lines.append("\tratio : float = 2.75;")
+
+	for line_index in range(rng.randrange(2, 7)):
+		line = rng.choice([
+			f"\ttotal = total + alpha * {rng.randrange(100000)} / beta - {rng.randrange(1000)};",
+			f"\tif (total >= {rng.randrange(1000)}) {{ total = total - alpha; }};",
+			f"\tratio = ratio * {rng.randrange(100)}.{rng.randrange(1000)};",
+			f"\tvalue_{line_index} : int = total - beta * {rng.randrange(100)};",
+		])
+		lines.append(rng.choice(COMMENTS) + line)
+
+	lines.append("\treturn total;")
+	lines.append("};")
+	return "\n".join(lines) + "\n\n"
+
+
+def make_source(rng, options):
+	parts = []
+	size = 0
+	index = 0
+
+	while size < options["size"] * timing.MB:
+		index += 1
+		part = function(rng, index)
+		parts.append(part)
+		size += len(part)
+
+	parts.append(f"func main() int {{\n\tt : int = 0;\n\tfunction_{index}(t, 1);\n\treturn t;\n}};\n")
+	return "".join(parts)
+
+
+
+if __name__ == "__main__":
+	sys.exit(timing.main(
+		"usage: python3 bench/lexer.py path/to/hawk [path/to/other/hawk ...] [-size=MB] [-runs=N]",
+		{"size": 16, "runs": 5},
+		make_source,
+	))
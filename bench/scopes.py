@@ -0,0 +1,49 @@
+# scope lookups on functions of deeply nested ifs with many locals in every block
+# 	every local is set from the one before it and from a local of a random outer block,
+# 	so most names are looked up through many scopes (SemanticAnalyzer and Compiler (IR) are what to compare)
+#
+# usage: python3 bench/scopes.py path/to/hawk [path/to/other/hawk ...] [-functions=N] [-depth=N] [-locals=N] [-runs=N]
+
+import sys
+
+import timing
+
+
+
+def function(rng, index, depth, locals):
+	lines = [f"func scopes_{index}(a: int) int {{", "\ts : int = a;"]
+
+	for level in range(depth):
+		indent = "\t" * (level % 8 + 1)
+		lines.append(f"{indent}if (s > {rng.randrange(100)}) {{")
+
+		for i in range(locals):
+			previous = f"l{level}_{i - 1}" if i > 0 else "s"
+			outer = f"l{rng.randrange(level)}_{rng.randrange(locals)}" if level > 0 else "a"
+			lines.append(f"{indent}\tl{level}_{i} : int = {previous} + {outer};")
+
+		lines.append(f"{indent}\ts = s - l{level}_{locals - 1};")
+
+	for level in reversed(range(depth)):
+		lines.append("\t" * (level % 8 + 1) + "};")
+
+	lines += ["\treturn s;", "};", ""]
+	return "\n".join(lines) + "\n"
+
+
+def make_source(rng, options):
+	parts = [function(rng, index, options["depth"], options["locals"]) for index in range(options["functions"])]
+
+	parts.append("func main() int {\n\tt : int = 0;\n")
+	parts += [f"\tscopes_{index}(t);\n" for index in range(options["functions"])]
+	parts.append("\treturn t;\n};\n")
+	return "".join(parts)
+
+
+
+if __name__ == "__main__":
+	sys.exit(timing.main(
+		"usage: python3 bench/scopes.py path/to/hawk [path/to/other/hawk ...] [-functions=N] [-depth=N] [-locals=N] [-runs=N]",
+		{"functions": 10, "depth": 300, "locals": 30, "runs": 5},
+		make_source,
+	))
@@ -0,0 +1,132 @@
+# runs hawk builds on a generated file and prints the best time of each phase (-time) and of the whole run
+# 	builds from before -time was added only get the whole run, so any two builds can be compared on the same file
+# 	the benchmarks in this folder only make the file, this runs it (python3 bench/<benchmark>.py -h)
+
+import os
+import random
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+
+
+COLOR = re.compile(r"\x1b\[[0-9;]*m")
+PHASE = re.compile(r"^(.+?): ([0-9.]+) ms")
+
+MB = 1 << 20
+
+
+def parse_args(usage, options):
+	hawks = []
+
+	for arg in sys.argv[1:]:
+		if arg == "-h":
+			hawks = []
+			break
+
+		if arg.startswith("-") and "=" in arg:
+			name, value = arg[1:].split("=", 1)
+			if name not in options:
+				print(f"unknown option: {arg}")
+				return None, options
+			options[name] = int(value)
+		else:
+			hawks.append(os.path.abspath(arg))
+
+	if len(hawks) == 0:
+		print(usage)
+		print("\toptions (default): " + ", ".join(f"-{name}={value}" for name, value in options.items()))
+		return None, options
+
+	return hawks, options
+
+
+
+def has_timing(hawk):
+	result = subprocess.run([hawk, "-nc", "-h"], capture_output = True, text = True, timeout = 60)
+	return "-time" in result.stdout
+
+
+# {phase: ms} of one run, the whole run is "total"
+def run_once(hawk, directory, file_name, timing):
+	output_path = os.path.join(directory, "output.ll")
+	if os.path.exists(output_path):
+		os.remove(output_path)
+
+	args = [hawk, file_name, "-nc", "-c=llvm"] + (["-time"] if timing else [])
+
+	start = time.perf_counter()
+	result = subprocess.run(args, cwd = directory, capture_output = True, text = True, timeout = 600)
+	total = (time.perf_counter() - start) * 1000.0
+
+	if result.returncode != 0 or not os.path.exists(output_path):
+		return None, result.stdout[-1000:]
+
+	phases = {}
+	for line in COLOR.sub("", result.stdout).splitlines():
+		match = PHASE.match(line)
+		if match is not None:
+			phases[match.group(1)] = float(match.group(2))
+
+	phases["total"] = total
+	return phases, None
+
+
+def run(hawks, runs, directory, file_name):
+	size = os.path.getsize(os.path.join(directory, file_name))
+	failures = 0
+
+	for hawk in hawks:
+		print(hawk)
+
+		timing = has_timing(hawk)
+		best = {}
+
+		for _ in range(runs):
+			phases, error = run_once(hawk, directory, file_name, timing)
+			if phases is None:
+				break
+
+			for phase, ms in phases.items():
+				best[phase] = min(best.get(phase, ms), ms)
+
+		if phases is None:
+			failures += 1
+			print("\tdidn't compile the file:")
+			print("\t" + error.replace("\n", "\n\t"))
+			continue
+
+		if not timing:
+			print("\t(no -time in this build)")
+
+		for phase, ms in best.items():
+			# the phases that lex, or the whole run if that's all there is
+			rate = f" ({size / MB / (ms / 1000.0):.1f} MB/s)" if phase.startswith("Tokenizer") or not timing else ""
+			print(f"\t{phase}: {ms:.3f} ms{rate}")
+
+	return failures
+
+
+
+def main(usage, options, make_source):
+	hawks, options = parse_args(usage, options)
+	if hawks is None:
+		return 2
+
+	source = make_source(random.Random(options.get("seed", 1)), options)
+
+	with tempfile.TemporaryDirectory() as root:
+		file_name = "bench.hawk"
+		with open(os.path.join(root, file_name), "w") as file:
+			file.write(source)
+
+		print(f"{file_name}: {len(source) / MB:.1f}MB, {source.count(chr(10))} lines, best of {options['runs']} runs")
+		failures = run(hawks, options["runs"], root, file_name)
+
+	if failures != 0:
+		print("FAILED")
+		return 1
+
+	return 0
@@ -51,6 +51,7 @@ project "hawk"
 
 	links{
 		"C:/Program Files (x86)/LLVM/lib/**.lib",
+		"ws2_32", -- compile server socket
 	}
 
 	linkoptions {
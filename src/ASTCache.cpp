@@ -0,0 +1,57 @@
+#include "pch.h"
+#include "ASTCache.h"
+
+
+namespace Hawk{
+
+	bool ASTCache::load(std::string_view source, AST::Tree& tree, symbols::Interner& interner) const {
+		uint64_t source_hash = files::hash(source);
+		auto path = this->get_path(source_hash);
+
+		auto file = files::MappedFile();
+		if(!file.open(path)){ return false; }
+
+		auto input = file.view();
+
+		auto header = Header();
+		if(!files::read_value(input, header)){ return false; }
+
+		if(header.magic != magic || header.format_version != format_version || header.version_hash != this->version_hash){
+			return false;
+		}
+
+		// the name only has the hash in it, so check that it's really the same file
+		if(header.source_size != source.size() || header.source_hash != source_hash){
+			return false;
+		}
+
+		if(!tree.read(input, interner)){
+			tree = AST::Tree(source);
+			return false;
+		}
+
+		return true;
+	};
+
+
+	bool ASTCache::save(std::string_view source, const AST::Tree& tree) const {
+		auto error = std::error_code();
+		fs::create_directories(this->directory, error);
+		if(error){ return false; }
+
+		uint64_t source_hash = files::hash(source);
+		auto header = Header(magic, format_version, uint32_t(source.size()), this->version_hash, source_hash);
+
+		auto output = std::string();
+		files::write_value(output, header);
+		tree.write(output);
+
+		return files::write(this->get_path(source_hash), output);
+	};
+
+
+	fs::path ASTCache::get_path(uint64_t source_hash) const {
+		return this->directory / fmt::format("{:016x}.hawkast", source_hash);
+	};
+
+}
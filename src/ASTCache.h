@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Parser.h"
+
+namespace Hawk{
+
+	// on-disk cache of parsed trees (one .hawkast file per source file contents)
+	// 	entries are named by a hash of the source, and the header also holds the compiler version,
+	// 	so an edited file or a different compiler just misses and overwrites the entry
+	class ASTCache{
+		public:
+			ASTCache(fs::path cache_directory, std::string_view compiler_version)
+				: directory(std::move(cache_directory)), version_hash(files::hash(compiler_version)) {};
+			~ASTCache() = default;
+
+			// false if there is no usable entry for `source` (`tree` is left empty)
+			// 	names are interned into `interner`
+			bool load(std::string_view source, AST::Tree& tree, symbols::Interner& interner) const;
+
+			// `tree` must not have been through the SemanticAnalyzer yet
+			bool save(std::string_view source, const AST::Tree& tree) const;
+
+			inline const fs::path& get_directory() const { return this->directory; };
+
+		private:
+			fs::path get_path(uint64_t source_hash) const;
+
+		private:
+			// bump when the layout of the file or of any AST node changes
+			static constexpr uint32_t format_version = 2;
+			static constexpr uint64_t magic = 0x5453414B57414800; // "\0HAWKAST"
+
+			struct Header{
+				uint64_t magic;
+				uint32_t format_version;
+				uint32_t source_size;
+				uint64_t version_hash;
+				uint64_t source_hash;
+			};
+
+		private:
+			fs::path directory;
+			uint64_t version_hash;
+	};
+
+}
@@ -3,44 +3,86 @@
 
 
 namespace Hawk{
-	
-	bool CharacterStream::end(){
-		return this->i + 1 == file.size();
+
+	CharacterStream::Location CharacterStream::get_location(uint position) const {
+		uint line_index = this->get_line_index(position);
+		return Location{line_index + 1, position - this->line_starts[line_index] + 1};
 	};
 
-	std::optional<char> CharacterStream::next(){
-		if(!this->end()){
-		    auto character = this->file[this->i];
-			this->i += 1;
-		    if(character == '\n'){
-		        this->line += 1;
-		        this->collumn = 1; 
-		        // line_str = "";
-		    // }else if(character == '\t'){
-		    //     this->collumn += 4;
-		    }else{
-		        this->collumn += 1;
-		        // line_str += character;
-		    }
-		    return std::optional<char>{character};
-		}else{
-			return std::nullopt;
+
+	std::string CharacterStream::get_snippet(uint start, uint length) const {
+		uint line_index = this->get_line_index(start);
+		uint line_start = this->line_starts[line_index];
+		uint line_end = line_index + 1 < this->line_starts.size() ? this->line_starts[line_index + 1] - 1 : this->size();
+
+		auto line = this->file.substr(line_start, line_end - line_start);
+		if(!line.empty() && line.back() == '\r'){
+			line.remove_suffix(1);
 		}
-	};
 
 
-	std::optional<char> CharacterStream::peek(int offset){
-		if(this->i + offset < this->file.size()){
-			return this->file[this->i + offset];
-		}else{
-			return std::nullopt;
+		// tabs are kept so the marker lines up with the source
+		auto marker = std::string();
+		for(uint i = line_start; i < start; i++){
+			marker += this->file[i] == '\t' ? '\t' : ' ';
+		}
+
+		uint marked_end = std::min(start + length, line_start + uint(line.size()));
+		marker += '^';
+		for(uint i = start + 1; i < marked_end; i++){
+			marker += '~';
 		}
+
+		// a '\0' would cut the message short when printed
+		auto line_str = std::string(line);
+		std::replace(line_str.begin(), line_str.end(), '\0', ' ');
+
+		return fmt::format("\t{:>5} | {}\n\t{:>5} | {}", line_index + 1, line_str, "", marker);
+	};
+
+
+
+	void CharacterStream::build_line_table() const {
+		const char* data = this->file.data();
+		const uint size = this->size();
+		const auto& scanner = simd::get_scanner();
+
+		this->line_starts.reserve(size / 32 + 1);
+		this->line_starts.emplace_back(0);
+
+		uint position = scanner.find_newline(data, 0, size);
+		while(position < size){
+			this->line_starts.emplace_back(position + 1);
+			position = scanner.find_newline(data, position + 1, size);
+		};
 	};
 
 
-	void CharacterStream::move(int amount){
-		this->i += amount;
+	uint CharacterStream::get_line_index(uint position) const {
+		std::call_once(this->line_table_built, [this](){ this->build_line_table(); });
+
+		// last line that starts at or before the position
+		auto line = std::upper_bound(this->line_starts.begin(), this->line_starts.end(), position);
+		return uint(line - this->line_starts.begin()) - 1;
 	};
 
 
+
+	//////////////////////////////////////////////////////////////////////
+	// SourceFiles
+
+	void SourceFiles::add(fs::path path, const CharacterStream& stream){
+		this->files.emplace_back(std::move(path), &stream, this->end);
+		this->end += stream.size();
+	};
+
+
+	const SourceFiles::File& SourceFiles::find(uint position) const {
+		// last file that starts at or before the position
+		auto file = std::upper_bound(this->files.begin(), this->files.end(), position, [](uint position, const File& file){
+			return position < file.start;
+		});
+		return *(file - 1);
+	};
+
 }
@@ -4,23 +4,64 @@ namespace Hawk{
 	
 	class CharacterStream{
 		public:
-			CharacterStream(const std::string& file_input) : file(file_input) {};
+			CharacterStream(std::string_view file_input) : file(file_input) {};
 			~CharacterStream() = default;
-	
-			bool end();
-			std::optional<char> next();
-			std::optional<char> peek(int offset = 0);
-			void move(int amount);
 
-			inline uint get_line() const { return this->line; };
-			inline uint get_collumn() const { return this->collumn; };
+			inline std::string_view get_file() const { return this->file; };
+			inline uint size() const { return uint(this->file.size()); };
+
+
+			struct Location{
+				uint line;
+				uint collumn;
+			};
+
+			// the line table is only built the first time a location is needed (diagnostics)
+			Location get_location(uint position) const;
+
+			// the line containing [start, start + length) with the range marked underneath
+			std::string get_snippet(uint start, uint length) const;
 
 		private:
-			const std::string& file;
-			uint i = 0;
+			void build_line_table() const;
+			uint get_line_index(uint position) const;
+
+		private:
+			std::string_view file;
+
+			// offset of the first char of every line
+			mutable std::vector<uint> line_starts{};
+			mutable std::once_flag line_table_built{};
+	};
+
 
-			uint line = 1;
-			uint collumn = 1;
+
+	// every file of a compilation, one after another in a single range of positions
+	// 	(position in the file + the size of every file before it), so the trees of several files can be merged into one
+	// 	and diagnostics can still find the file a token is from
+	class SourceFiles{
+		public:
+			struct File{
+				fs::path path;
+				const CharacterStream* stream;
+				uint start; // position of the first char
+			};
+
+		public:
+			SourceFiles() = default;
+			~SourceFiles() = default;
+
+			// must be added in the same order as their trees are merged
+			void add(fs::path path, const CharacterStream& stream);
+
+			// the file that `position` is in (the end of the last char of a file is the start of the next one)
+			const File& find(uint position) const;
+
+			inline size_t size() const { return this->files.size(); };
+
+		private:
+			std::vector<File> files;
+			uint end = 0;
 	};
 
 }
@@ -0,0 +1,180 @@
+#include "pch.h"
+#include "CompileServer.h"
+
+
+namespace Hawk{
+
+	//////////////////////////////////////////////////////////////////////
+	// ResidentFiles
+
+	auto ResidentFiles::load(const fs::path& path) -> File* {
+		auto mapped_file = files::MappedFile();
+		if(!mapped_file.open(path)){ return nullptr; }
+		auto source = mapped_file.view();
+
+		auto error_code = std::error_code();
+		auto key = fs::weakly_canonical(path, error_code).string();
+		auto& file = this->files[key];
+
+
+		if(file == nullptr){
+			file = std::make_unique<File>();
+			file->source = std::string(source);
+			file->char_stream = std::make_unique<CharacterStream>(file->source);
+
+			auto tokenizer = Tokenizer(*file->char_stream);
+			file->parser = std::make_unique<Parser>(tokenizer);
+			file->parser->start();
+
+		}else if(file->source != source || !file->parser->success()){
+			// the tree doesn't need the old source to be reparsed (the tokens it keeps are pointed at the new one)
+			auto edit = Parser::find_edit(file->source, source);
+			file->source = std::string(source);
+			file->char_stream = std::make_unique<CharacterStream>(file->source);
+
+			file->parser->reparse(*file->char_stream, edit);
+		}
+
+		return file.get();
+	};
+
+
+
+	//////////////////////////////////////////////////////////////////////
+	// CompileServer
+
+	int CompileServer::run(){
+		auto listener = sockets::Listener();
+		if(!listener.open(this->socket_path)){
+			cmd::error("unable to open the socket \"{}\"", this->socket_path.string());
+			return -1;
+		}
+
+		cmd::info("Hawk compile server listening on \"{}\" (stop it with `hawk -client -stop`)", this->socket_path.string());
+		const bool server_uses_color = cmd::using_color();
+
+
+		while(true){
+			auto connection = listener.accept();
+
+			auto request = std::string();
+			if(!connection.receive(request)){ continue; }
+
+			auto input = std::string_view(request);
+			auto working_directory = std::string_view();
+			auto argv = std::vector<std::string>{this->program_path};
+
+			bool valid_request = read_string(input, working_directory);
+			for(auto arg = std::string_view(); valid_request && !input.empty();){
+				valid_request = read_string(input, arg);
+				argv.emplace_back(arg);
+			};
+
+			if(!valid_request){ continue; }
+
+			if(argv.size() == 2 && argv[1] == "-stop"){
+				auto response = std::string();
+				files::write_value(response, int32_t(0));
+				write_string(response, "Hawk compile server stopped\n");
+				connection.send(response);
+				return 0;
+			}
+
+
+			// relative paths in the args (and the output files) are from the client's working directory
+			auto output = std::string();
+			int32_t exit_code = -1;
+
+			cmd::capture_output(&output);
+
+			auto error_code = std::error_code();
+			fs::current_path(working_directory, error_code);
+
+			if(error_code){
+				cmd::error("unable to change to the directory \"{}\"", working_directory);
+
+			}else{
+				try{
+					exit_code = this->compile(std::move(argv), this->resident_files);
+				}catch(const std::exception& exception){
+					cmd::error("Internal compiler error: {}", exception.what());
+				}
+			}
+
+			cmd::capture_output(nullptr);
+
+			// flags like -nc only apply to the request they came with
+			if(server_uses_color){ cmd::use_color(); }
+
+
+			auto response = std::string();
+			files::write_value(response, exit_code);
+			write_string(response, output);
+			connection.send(response);
+		};
+	};
+
+
+
+	int CompileServer::run_client(const fs::path& socket_path, std::span<const std::string> args){
+		auto connection = sockets::connect(socket_path);
+		if(!connection.is_open()){
+			cmd::error("no compile server is listening on \"{}\" (start one with `hawk -server`)", socket_path.string());
+			return -1;
+		}
+
+		auto request = std::string();
+		write_string(request, fs::current_path().string());
+		for(const auto& arg : args){
+			write_string(request, arg);
+		}
+
+		auto response = std::string();
+		if(!connection.send(request) || !connection.receive(response)){
+			cmd::error("lost the connection to the compile server");
+			return -1;
+		}
+
+
+		auto input = std::string_view(response);
+		int32_t exit_code = -1;
+		auto output = std::string_view();
+
+		if(!files::read_value(input, exit_code) || !read_string(input, output)){
+			cmd::error("invalid response from the compile server");
+			return -1;
+		}
+
+		std::fwrite(output.data(), 1, output.size(), stdout);
+		return exit_code;
+	};
+
+
+	fs::path CompileServer::get_default_socket_path(){
+		auto error_code = std::error_code();
+		auto directory = fs::temp_directory_path(error_code);
+		return (error_code ? fs::path(".") : directory) / "hawk-server.sock";
+	};
+
+
+
+	// padded to 8 bytes like the values of files::write_value()
+	void CompileServer::write_string(std::string& output, std::string_view str){
+		files::write_value(output, uint64_t(str.size()));
+		output.append(str);
+		output.resize((output.size() + 7) & ~size_t(7), '\0');
+	};
+
+	bool CompileServer::read_string(std::string_view& input, std::string_view& str){
+		uint64_t size = 0;
+		if(!files::read_value(input, size)){ return false; }
+
+		uint64_t padded_size = (size + 7) & ~uint64_t(7);
+		if(input.size() < padded_size){ return false; }
+
+		str = input.substr(0, size);
+		input.remove_prefix(padded_size);
+		return true;
+	};
+
+}
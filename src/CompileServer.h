@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CharacterStream.h"
+#include "Parser.h"
+#include "SemanticAnalyzer.h"
+
+namespace Hawk{
+
+	// the front end state the compile server keeps for every file it compiled
+	// 	an unchanged file isn't parsed again, and an edited one only has the statements the edit touched parsed again (Parser::reparse())
+	// 	names are interned into the shared interner, which stays alive with the server
+	// 	the inferred return types of the functions are kept too, the ones an edit didn't affect aren't inferred again
+	class ResidentFiles{
+		public:
+			struct File{
+				std::string source{};
+				std::unique_ptr<CharacterStream> char_stream{};
+
+				// the tree is never given to the SemanticAnalyzer, it's appended to the tree that is
+				// 	(its tokenizer is only alive for the first parse, reparse() makes its own)
+				std::unique_ptr<Parser> parser{};
+			};
+
+		public:
+			ResidentFiles() = default;
+			~ResidentFiles() = default;
+
+			// reads the file and parses what changed since the last time, nullptr if it can't be read
+			// 	parse errors are printed as usual (file->parser->success() is false)
+			File* load(const fs::path& path);
+
+		public:
+			// of the last error free compile, whatever files it had
+			Signatures signatures{};
+
+		private:
+			std::unordered_map<std::string, std::unique_ptr<File>> files;
+	};
+
+
+
+	// compiles the requests of `hawk -client` (over a local socket) until it's stopped
+	// 	the process stays alive between compiles, so the interner and the trees of the files it has seen stay warm
+	class CompileServer{
+		public:
+			// runs `hawk` with the args of a request (argv[0] is the path of the server)
+			using Compile = std::function<int(std::vector<std::string>&& argv, ResidentFiles& resident_files)>;
+
+		public:
+			CompileServer(fs::path socket_path, std::string program_path, Compile compile)
+				: socket_path(std::move(socket_path)), program_path(std::move(program_path)), compile(std::move(compile)) {};
+			~CompileServer() = default;
+
+			// only returns if the socket can't be opened
+			int run();
+
+			// sends the args (without argv[0]) to the server at `socket_path` and prints what it sent back
+			static int run_client(const fs::path& socket_path, std::span<const std::string> args);
+
+			static fs::path get_default_socket_path();
+
+		private:
+			// request:  the client's working directory, then the args
+			// response: the exit code, then the output
+			static void write_string(std::string& output, std::string_view str);
+			static bool read_string(std::string_view& input, std::string_view& str);
+
+		private:
+			fs::path socket_path;
+			std::string program_path;
+			Compile compile;
+
+			ResidentFiles resident_files{};
+	};
+
+}
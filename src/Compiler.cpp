@@ -6,17 +6,23 @@
 
 
 namespace Hawk{
+
 	
-	Compiler::Compiler(std::map<std::string, AST::VarDecl*>& global_vars, 
-					const std::map<std::string, AST::FuncDef*>& functions,
+	Compiler::Compiler(const AST::Tree& ast,
+					const symbols::Map<AST::Index<AST::VarDecl>>& global_vars, 
+					const symbols::Map<AST::Index<AST::FuncDef>>& functions,
+					const types::Table& types,
+					const ConstEvaluator& const_evaluator,
 					const std::string& package_name) 
-		: global_vars(global_vars), functions(functions), /*package_name(package_name),*/ 
+		: tree(ast), global_vars(global_vars), functions(functions), types(types), const_evaluator(const_evaluator), /*package_name(package_name),*/ 
 			context(), builder(context), module(package_name, context) {
 		
-		this->types["int"] = this->builder.getInt64Ty();
-		this->types["float"] = this->builder.getDoubleTy();
-		this->types["bool"] = this->builder.getInt1Ty();
-		this->types["void"] = this->builder.getVoidTy();
+		// only the built in types can get here (any other type name is an error in the SemanticAnalyzer)
+		this->llvm_types.resize(this->types.size(), nullptr);
+		this->llvm_types[types::type_int] = this->builder.getInt64Ty();
+		this->llvm_types[types::type_float] = this->builder.getDoubleTy();
+		this->llvm_types[types::type_bool] = this->builder.getInt1Ty();
+		this->llvm_types[types::type_void] = this->builder.getVoidTy();
 
 	}
 	
@@ -27,38 +33,39 @@ namespace Hawk{
 
 	void Compiler::build_ir(){
 		
-		for(auto [name, var_decl] : this->global_vars){
-			auto var_name = var_decl->id->token.value;
-			auto type_str = var_decl->type->token.value;
-			auto type = this->types[type_str];
+		for(auto [name, var_decl_index] : this->global_vars){
+			auto& var_decl = this->tree.get(var_decl_index);
+			auto var_name = this->tree.get_token(var_decl.id).value;
+			auto type = this->llvm_types[var_decl.type_id];
 			auto is_constant = false;
 
 
-			auto* global = new llvm::GlobalVariable(this->module, type, is_constant, llvm::GlobalValue::PrivateLinkage, this->get_llvm_constant(var_decl->value), var_name);
+			auto* global = new llvm::GlobalVariable(this->module, type, is_constant, llvm::GlobalValue::PrivateLinkage, this->get_global_initializer(var_decl_index), var_name);
 			global->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
 			global->setAlignment(llvm::Align(1));
-			this->global_llvm_vars[var_name] = global;
+			this->global_llvm_vars[name] = global;
 		}
 
 		this->import_externs();
 
 
-		for(auto [name, func_def] : this->functions){
-			auto return_type_str = func_def->return_type->token.value;
-			auto return_type = this->types[return_type_str];
+		for(auto [name, func_def_index] : this->functions){
+			auto& func_def = this->tree.get(func_def_index);
+			auto return_type = this->llvm_types[func_def.return_type_id];
 
 			std::vector<llvm::Type*> params;
-			for(auto* param : func_def->params->params){
-				params.push_back(this->types[param->type->token.value]);
+			for(auto& param : this->tree.get(func_def.params)){
+				params.push_back(this->llvm_types[param.type_id]);
 			}
 
 			auto prototype = llvm::FunctionType::get(return_type, params, false);
-			llvm::Function* function = llvm::Function::Create(prototype, llvm::Function::ExternalLinkage, name, this->module);
+			llvm::Function* function = llvm::Function::Create(prototype, llvm::Function::ExternalLinkage, this->tree.get_token(func_def.id).value, this->module);
 			this->llvm_functions[name] = function;
 		}
 
-		for(auto [name, func_def] : this->functions){
-			auto return_type_str = func_def->return_type->token.value;
+		for(auto [name, func_def_index] : this->functions){
+			auto& func_def = this->tree.get(func_def_index);
+			auto return_type = func_def.return_type_id;
 			auto* function = this->llvm_functions[name];
 
 
@@ -70,10 +77,11 @@ namespace Hawk{
 			this->enter_scope();
 
 				uint counter = 0;
-				auto ast_params = func_def->params->params;
+				auto ast_params = this->tree.get(func_def.params);
 				for(auto& arg : function->args()){
-					auto arg_name = ast_params[counter]->id->token.value;
-					auto arg_type = this->types[ast_params[counter]->type->token.value];
+					auto arg_id = this->tree.get_token(ast_params[counter].id);
+					auto arg_name = arg_id.value;
+					auto arg_type = this->llvm_types[ast_params[counter].type_id];
 
 
 					llvm::IRBuilder<> temp_builder(body, body->begin());
@@ -81,18 +89,18 @@ namespace Hawk{
 
 					this->builder.CreateStore(&arg, alloca);
 
-					this->add_to_scope(arg_name, alloca);
+					this->add_to_scope(arg_id.symbol, alloca);
 
 					counter += 1;
 				}
 
-				for(auto* stmt : func_def->block->stmts){
-					this->parse_stmt(stmt, func_def);
+				for(auto stmt : this->tree.get(this->tree.get(func_def.block).stmts)){
+					this->parse_stmt(stmt);
 				}
 			this->leave_scope();
 
 
-			if(return_type_str == "void"){
+			if(return_type == types::type_void){
 				this->builder.CreateRet(0);
 			}
 
@@ -109,7 +117,7 @@ namespace Hawk{
 			auto prototype = llvm::FunctionType::get(this->builder.getInt8Ty(), true);
 			auto function = llvm::Function::Create(prototype, llvm::Function::ExternalLinkage, "printf", this->module);
 
-			this->llvm_functions["printf"] = function;
+			this->llvm_functions[symbols::func_printf] = function;
 		}
 
 
@@ -121,53 +129,102 @@ namespace Hawk{
 
 
 
-	void Compiler::parse_stmt(AST::Stmt* stmt, AST::FuncDef* func_def){
+	// walks the statement with an explicit stack, so deeply nested conditionals can't overflow the call stack
+	// 	what a conditional emits after its then / else block is pushed as its own work, under the block
+	void Compiler::parse_stmt(AST::Stmt stmt){
+		auto& stack = this->stmt_stack;
+		stack.push_back(StmtWork(StmtWork::Kind::stmt, stmt));
+
+		while(!stack.empty()){
+			auto work = stack.back();
+			stack.pop_back();
+
+			switch(work.kind){
+				case StmtWork::Kind::stmt: {
+					this->emit_stmt(work.stmt);
+
+				} break; case StmtWork::Kind::leave_scope: {
+					this->leave_scope();
+
+				} break; case StmtWork::Kind::end_then: {
+					if(!this->just_returned){
+						builder.CreateBr(work.merge_block);
+					}else{
+						this->just_returned = false;
+					}
+
+					auto current_func = builder.GetInsertBlock()->getParent();
+
+					if(work.else_block != nullptr){
+						current_func->getBasicBlockList().push_back(work.else_block);
+						this->builder.SetInsertPoint(work.else_block);
+
+						stack.push_back(StmtWork(StmtWork::Kind::end_else, work.stmt, nullptr, work.merge_block));
+						stack.push_back(StmtWork(StmtWork::Kind::stmt, this->tree.get<AST::Conditional>(work.stmt).else_block));
+					}else{
+						current_func->getBasicBlockList().push_back(work.merge_block);
+						this->builder.SetInsertPoint(work.merge_block);
+					}
+
+				} break; case StmtWork::Kind::end_else: {
+					if(!this->just_returned){
+						builder.CreateBr(work.merge_block);
+					}else{
+						this->just_returned = false;
+					}
+
+					auto current_func = builder.GetInsertBlock()->getParent();
+					current_func->getBasicBlockList().push_back(work.merge_block);
+					this->builder.SetInsertPoint(work.merge_block);
+				} break;
+			};
+		};
+	};
+
+
+	void Compiler::emit_stmt(AST::Stmt stmt){
 		this->just_returned = false;
 
-		switch(stmt->get_type()){
+		switch(stmt.get_type()){
 			case AST::StmtType::VarDecl: {
-				auto var_decl = static_cast<AST::VarDecl*>(stmt);
-				auto var_name = var_decl->id->token.value;
-				auto type_str = var_decl->type->token.value;
-				auto var_type = this->types[type_str];
+				auto& var_decl = this->tree.get<AST::VarDecl>(stmt);
+				auto var_id = this->tree.get_token(var_decl.id);
+				auto var_name = var_id.value;
+				auto var_type = this->llvm_types[var_decl.type_id];
 
 
 				llvm::AllocaInst* alloca = builder.CreateAlloca(var_type, nullptr, var_name);
-				auto store = builder.CreateStore(this->get_llvm_value(var_decl->value), alloca);
-				this->add_to_scope(var_name, alloca);
+				auto store = builder.CreateStore(this->get_llvm_value(var_decl.value), alloca);
+				this->add_to_scope(var_id.symbol, alloca);
 
 			} break; case AST::StmtType::ReturnStmt: {
-				auto* return_stmt = static_cast<AST::ReturnStmt*>(stmt);
-				auto* return_value = this->get_llvm_value(return_stmt->expr);
+				auto& return_stmt = this->tree.get<AST::ReturnStmt>(stmt);
+				auto* return_value = this->get_llvm_value(return_stmt.expr);
 
 				builder.CreateRet(return_value);
 				this->just_returned = true;
 
 			} break; case AST::StmtType::VarAssign: {
-				auto var_assign = static_cast<AST::VarAssign*>(stmt);
-				auto var_name = var_assign->id->token.value;
-
-
-				auto alloca = this->in_scope(var_name);
-				builder.CreateStore(this->get_llvm_value(var_assign->value), alloca);
+				auto& var_assign = this->tree.get<AST::VarAssign>(stmt);
+				auto alloca = this->in_scope(this->tree.get_token(var_assign.id).symbol);
+				builder.CreateStore(this->get_llvm_value(var_assign.value), alloca);
 
 			} break; case AST::StmtType::FuncCallStmt: {
-				auto func_call = static_cast<AST::FuncCallStmt*>(stmt)->expr;
-				auto func_name = func_call->id->token.value;
-				auto params = func_call->params->params;
+				auto& func_call = this->tree.get(this->tree.get<AST::FuncCallStmt>(stmt).expr);
+				auto func_name = this->tree.get_token(func_call.id).symbol;
+				auto params = this->tree.get(func_call.params);
 
-				if(func_name == "printf"){
+				if(func_name == symbols::func_printf){
 					auto format_str = builder.CreateGlobalStringPtr("Printed from libc::printf (%f)\n");
 
-					auto first = params[0]->expr;
 					auto val = this->get_llvm_value(params[0]);
 
-					builder.CreateCall(this->llvm_functions["printf"], { format_str, val });
+					builder.CreateCall(this->llvm_functions[symbols::func_printf], { format_str, val });
 				}else{
 
 					std::vector<llvm::Value*> arguments;
 					arguments.reserve(params.size());
-					for(auto* param : params){
+					for(auto param : params){
 						arguments.push_back(this->get_llvm_value(param));
 					}
 
@@ -175,27 +232,27 @@ namespace Hawk{
 				}
 
 			} break; case AST::StmtType::Block: {
-				auto block = static_cast<AST::Block*>(stmt);
+				auto block_stmts = this->tree.get(this->tree.get<AST::Block>(stmt).stmts);
 
 				this->enter_scope();
-				for(auto* block_stmt : block->stmts){
-					this->parse_stmt(block_stmt, func_def);
+				this->stmt_stack.push_back(StmtWork(StmtWork::Kind::leave_scope));
+				for(auto block_stmt = block_stmts.rbegin(); block_stmt != block_stmts.rend(); block_stmt++){
+					this->stmt_stack.push_back(StmtWork(StmtWork::Kind::stmt, *block_stmt));
 				}
-				this->leave_scope();
 
 			} break; case AST::StmtType::Conditional: {
-				auto conditional = static_cast<AST::Conditional*>(stmt);
-				auto cond_value = this->get_llvm_value(conditional->cond);
+				auto& conditional = this->tree.get<AST::Conditional>(stmt);
+				auto cond_value = this->get_llvm_value(conditional.cond);
 
 				auto current_func = builder.GetInsertBlock()->getParent();
 
 				llvm::BasicBlock* then_block;
-				llvm::BasicBlock* else_block;
+				llvm::BasicBlock* else_block = nullptr;
 				llvm::BasicBlock* merge_block;
 
 
 
-				if(conditional->else_block != nullptr){
+				if(!conditional.else_block.is_none()){
 					then_block = llvm::BasicBlock::Create(this->context, "then", current_func);
 					else_block = llvm::BasicBlock::Create(this->context, "else");
 					merge_block = llvm::BasicBlock::Create(this->context, "if_merge");
@@ -211,39 +268,12 @@ namespace Hawk{
 				
 
 				//////////////////////////////////////////////////////////////////////
-				// then
+				// then (the else and merge blocks are emitted by the end_then work)
 
 				this->builder.SetInsertPoint(then_block);
-					this->parse_stmt(conditional->then_block, func_def);
-					if(!this->just_returned){
-						builder.CreateBr(merge_block);
-					}else{
-						this->just_returned = false;
-					}
-					then_block = builder.GetInsertBlock();
-
-
-				//////////////////////////////////////////////////////////////////////
-				// else
-
-				if(conditional->else_block != nullptr){
-					current_func->getBasicBlockList().push_back(else_block);
-					this->builder.SetInsertPoint(else_block);
-						this->parse_stmt(conditional->else_block, func_def);
-						if(!this->just_returned){
-							builder.CreateBr(merge_block);
-						}else{
-							this->just_returned = false;
-						}
-						else_block = builder.GetInsertBlock();
 
-				}
-
-				//////////////////////////////////////////////////////////////////////
-				// emit merge
-
-				current_func->getBasicBlockList().push_back(merge_block);
-				this->builder.SetInsertPoint(merge_block);
+				this->stmt_stack.push_back(StmtWork(StmtWork::Kind::end_then, stmt, else_block, merge_block));
+				this->stmt_stack.push_back(StmtWork(StmtWork::Kind::stmt, conditional.then_block));
 
 
 			} break; default: return;
@@ -254,135 +284,220 @@ namespace Hawk{
 
 
 
-	llvm::Value* Compiler::get_llvm_value(AST::Expr* expr){
-		switch(expr->get_type()){
+	llvm::Value* Compiler::get_llvm_value(AST::Expr expr){
+		switch(expr.get_type()){
 			case AST::ExprType::Literal: {
-				auto literal = static_cast<AST::Literal*>(expr);
-
-				if(literal->token.type == TokenType::literal_int){
-					return llvm::ConstantInt::get(this->types["int"], std::stoll(static_cast<AST::Literal*>(expr)->token.value));
-				}else if(literal->token.type == TokenType::literal_float){
-					return llvm::ConstantFP::get(this->types["float"], std::stod(static_cast<AST::Literal*>(expr)->token.value));
-				}else if(literal->token.type == TokenType::literal_bool){
-					return llvm::ConstantInt::get(this->types["bool"], static_cast<AST::Literal*>(expr)->token.value == "true" ? 1 : 0);
+				auto literal = this->tree.get_token(expr);
+
+				if(literal.type == TokenType::literal_int){
+					return llvm::ConstantInt::get(this->llvm_types[types::type_int], ConstEvaluator::parse_int(literal.value));
+				}else if(literal.type == TokenType::literal_float){
+					return llvm::ConstantFP::get(this->llvm_types[types::type_float], ConstEvaluator::parse_float(literal.value));
+				}else if(literal.type == TokenType::literal_bool){
+					return llvm::ConstantInt::get(this->llvm_types[types::type_bool], literal.value == "true" ? 1 : 0);
 				}else{
-					cmd::fatal("Recieved unknown literal type ({})", (int)expr->get_type());
+					cmd::fatal("Recieved unknown literal type ({})", (int)expr.get_type());
 				}
 
 			} break;case AST::ExprType::Id: {
-				auto* alloca = this->in_scope(static_cast<AST::Id*>(expr)->token.value);
+				auto var_name = this->tree.get_token(expr).symbol;
+				auto* alloca = this->in_scope(var_name);
 				if(alloca != nullptr){
 					return this->builder.CreateLoad(alloca->getAllocatedType(), alloca);
 				}else{
-					auto var_name = static_cast<AST::Id*>(expr)->token.value;
-					auto type_name = this->global_vars[var_name]->type->token.value;
+					auto type = this->tree.get(*this->global_vars.find(var_name)).type_id;
 
 
 					auto global = this->global_llvm_vars[var_name];
-					return this->builder.CreateLoad(this->types[type_name], global);
+					return this->builder.CreateLoad(this->llvm_types[type], global);
 				}
 
 			} break;case AST::ExprType::FuncCall: {
-				auto func_call = static_cast<AST::FuncCall*>(expr);
-				auto func_name = func_call->id->token.value;
-				auto params = func_call->params->params;
+				auto& func_call = this->tree.get<AST::FuncCall>(expr);
+				auto func_name = this->tree.get_token(func_call.id).symbol;
+				auto params = this->tree.get(func_call.params);
+
+				// run at compile time
+				if(const auto* folded = this->const_evaluator.get_folded(AST::Index<AST::FuncCall>(expr.index())); folded != nullptr){
+					return this->get_llvm_constant(this->tree.get(*this->functions.find(func_name)).return_type_id, *folded);
+				}
 
 				std::vector<llvm::Value*> arguments;
 				arguments.reserve(params.size());
-				for(auto* param : params){
+				for(auto param : params){
 					arguments.push_back(this->get_llvm_value(param));
 				}
 
 				return builder.CreateCall(this->llvm_functions[func_name], arguments);
 
 			} break;case AST::ExprType::Binary: {
-				auto* binary = static_cast<AST::Binary*>(expr);
-				auto* left = this->get_llvm_value(binary->left);
-				auto* right = this->get_llvm_value(binary->right);
+				// operator chains nest as deep as they are long, so the operands are visited with an explicit stack
+				// 	a binary is pushed again (as visited) under its operands and emitted once both operand values are on value_stack
+				size_t expr_start = this->expr_stack.size();
+				size_t value_start = this->value_stack.size();
 
-				if(binary->type == nullptr){
-					cmd::fatal("Compiler recieved binary expr type as nullptr");
-					cmd::fatal("It should have been set in the SemanticAnalyzer");
-				}
+				this->expr_stack.emplace_back(expr, false);
+
+				while(this->expr_stack.size() > expr_start){
+					auto [current, visited] = this->expr_stack.back();
+					this->expr_stack.pop_back();
+
+					if(current.get_type() != AST::ExprType::Binary){
+						auto* value = this->get_llvm_value(current);
+						this->value_stack.push_back(value);
+
+					}else if(!visited){
+						auto& binary = this->tree.get<AST::Binary>(current);
+						this->expr_stack.emplace_back(current, true);
+						this->expr_stack.emplace_back(binary.right, false);
+						this->expr_stack.emplace_back(binary.left, false);
+
+					}else{
+						auto* right = this->value_stack.back();
+						this->value_stack.pop_back();
+						auto*& left = this->value_stack.back();
 
-				auto expr_type = binary->type->token.value;
-
-				if(expr_type == "int"){
-					switch(binary->op.type){
-						break;case TokenType::op_plus: return builder.CreateAdd(left, right, "<add>");
-						break;case TokenType::op_minus: return builder.CreateSub(left, right, "<sub>");
-						break;case TokenType::op_mult: return builder.CreateMul(left, right, "<mul>");
-						break;case TokenType::op_div: return builder.CreateSDiv(left, right, "<div>");
-
-						break;case TokenType::op_lt:	return builder.CreateICmpSLT(left, right, "<");
-						break;case TokenType::op_lte:	return builder.CreateICmpSLE(left, right, "<=");
-						break;case TokenType::op_gt:	return builder.CreateICmpSGT(left, right, ">");
-						break;case TokenType::op_gte:	return builder.CreateICmpSGE(left, right, "<=");
-						break;case TokenType::op_eq:	return builder.CreateICmpEQ(left, right, "==");
-						break;case TokenType::op_neq:	return builder.CreateICmpNE(left, right, "!=");
-
-						break;default: cmd::fatal("Recieved unknown binary op type ({}) for int expr", (int)binary->op.type);
-					};
-				}else if(expr_type == "float"){
-					switch(binary->op.type){
-						break;case TokenType::op_plus: return builder.CreateFAdd(left, right, "<add>");
-						break;case TokenType::op_minus: return builder.CreateFSub(left, right, "<sub>");
-						break;case TokenType::op_mult: return builder.CreateFMul(left, right, "<mul>");
-						break;case TokenType::op_div: return builder.CreateFDiv(left, right, "<div>");
-
-						break;case TokenType::op_lt:	return builder.CreateFCmpOLT(left, right, "<");
-						break;case TokenType::op_lte:	return builder.CreateFCmpOLE(left, right, "<=");
-						break;case TokenType::op_gt:	return builder.CreateFCmpOGT(left, right, ">");
-						break;case TokenType::op_gte:	return builder.CreateFCmpOGE(left, right, "<=");
-						break;case TokenType::op_eq:	return builder.CreateFCmpOEQ(left, right, "==");
-						break;case TokenType::op_neq:	return builder.CreateFCmpONE(left, right, "!=");
-
-
-						break;default: cmd::fatal("Recieved unknown binary op type ({}) for float expr", (int)binary->op.type);
-					};
-					
-				}else if(expr_type == "bool"){
-					switch(binary->op.type){
-						break;case TokenType::op_eq:	return builder.CreateICmpEQ(left, right, "==");
-						break;case TokenType::op_neq:	return builder.CreateICmpNE(left, right, "!=");
-
-						break;case TokenType::op_and:	return builder.CreateLogicalAnd(left, right, "&&");
-						break;case TokenType::op_or:	return builder.CreateLogicalOr(left, right, "||");
-
-						break;default: cmd::fatal("Recieved unknown binary op type ({}) for bool expr", (int)binary->op.type);
+						left = this->get_llvm_binary(current, left, right);
 					}
-				}else{
-					cmd::fatal("Recieved unknown binary expr type ({})", expr_type);
-				}
+				};
+
+				auto* output = this->value_stack.back();
+				this->value_stack.resize(value_start);
+				return output;
+
+			} break; default: cmd::fatal("Recieved unknown Expr type for llvm_value ({})", (int)expr.get_type());
+		};
+
+		return nullptr;
+	};
+
+
+	llvm::Value* Compiler::get_llvm_binary(AST::Expr expr, llvm::Value* left, llvm::Value* right){
+		auto& binary = this->tree.get<AST::Binary>(expr);
+
+		if(binary.type == types::none){
+			cmd::fatal("Compiler recieved binary expr without a type");
+			cmd::fatal("It should have been set in the SemanticAnalyzer");
+		}
+
+		auto op = this->tree.tokens.kind(binary.op);
+
+		// comparisons are typed bool, so the instruction is picked by the type of the operands
+		auto operand_type = types::type_bool;
+		if(left->getType() == this->llvm_types[types::type_int]){
+			operand_type = types::type_int;
+		}else if(left->getType() == this->llvm_types[types::type_float]){
+			operand_type = types::type_float;
+		}
+
+		switch(operand_type){
+			case types::type_int: switch(op){
+				break;case TokenType::op_plus: return builder.CreateAdd(left, right, "<add>");
+				break;case TokenType::op_minus: return builder.CreateSub(left, right, "<sub>");
+				break;case TokenType::op_mult: return builder.CreateMul(left, right, "<mul>");
+				break;case TokenType::op_div: return builder.CreateSDiv(left, right, "<div>");
+
+				break;case TokenType::op_lt:	return builder.CreateICmpSLT(left, right, "<");
+				break;case TokenType::op_lte:	return builder.CreateICmpSLE(left, right, "<=");
+				break;case TokenType::op_gt:	return builder.CreateICmpSGT(left, right, ">");
+				break;case TokenType::op_gte:	return builder.CreateICmpSGE(left, right, "<=");
+				break;case TokenType::op_eq:	return builder.CreateICmpEQ(left, right, "==");
+				break;case TokenType::op_neq:	return builder.CreateICmpNE(left, right, "!=");
+
+				break;default: cmd::fatal("Recieved unknown binary op type ({}) for int expr", (int)op);
+			} break;
+
+			case types::type_float: switch(op){
+				break;case TokenType::op_plus: return builder.CreateFAdd(left, right, "<add>");
+				break;case TokenType::op_minus: return builder.CreateFSub(left, right, "<sub>");
+				break;case TokenType::op_mult: return builder.CreateFMul(left, right, "<mul>");
+				break;case TokenType::op_div: return builder.CreateFDiv(left, right, "<div>");
+
+				break;case TokenType::op_lt:	return builder.CreateFCmpOLT(left, right, "<");
+				break;case TokenType::op_lte:	return builder.CreateFCmpOLE(left, right, "<=");
+				break;case TokenType::op_gt:	return builder.CreateFCmpOGT(left, right, ">");
+				break;case TokenType::op_gte:	return builder.CreateFCmpOGE(left, right, "<=");
+				break;case TokenType::op_eq:	return builder.CreateFCmpOEQ(left, right, "==");
+				break;case TokenType::op_neq:	return builder.CreateFCmpONE(left, right, "!=");
+
 
+				break;default: cmd::fatal("Recieved unknown binary op type ({}) for float expr", (int)op);
+			} break;
 
+			case types::type_bool: switch(op){
+				break;case TokenType::op_eq:	return builder.CreateICmpEQ(left, right, "==");
+				break;case TokenType::op_neq:	return builder.CreateICmpNE(left, right, "!=");
 
-			} break; default: cmd::fatal("Recieved unknown Expr type for llvm_value ({})", (int)expr->get_type());
+				break;case TokenType::op_and:	return builder.CreateLogicalAnd(left, right, "&&");
+				break;case TokenType::op_or:	return builder.CreateLogicalOr(left, right, "||");
+
+				break;default: cmd::fatal("Recieved unknown binary op type ({}) for bool expr", (int)op);
+			} break;
+
+			default: cmd::fatal("Recieved unknown binary expr type ({})", this->types.print(binary.type));
 		};
 
 		return nullptr;
 	};
 
 
-	llvm::Constant* Compiler::get_llvm_constant(AST::Expr* expr){
-		switch(expr->get_type()){
+	// a global without a value starts at zero
+	llvm::Constant* Compiler::get_global_initializer(AST::Index<AST::VarDecl> var_decl){
+		const auto& var_decl_node = this->tree.get(var_decl);
+		if(var_decl_node.value.is_none()){
+			return llvm::Constant::getNullValue(this->llvm_types[var_decl_node.type_id]);
+		}
+		return this->get_llvm_constant(var_decl_node.value);
+	};
+
+	llvm::Constant* Compiler::get_llvm_constant(AST::Expr expr){
+		switch(expr.get_type()){
 			case AST::ExprType::Literal: {
-				auto literal = static_cast<AST::Literal*>(expr);
-
-				if(literal->token.type == TokenType::literal_int){
-					return llvm::ConstantInt::get(this->types["int"], std::stoll(static_cast<AST::Literal*>(expr)->token.value));
-				}else if(literal->token.type == TokenType::literal_float){
-					return llvm::ConstantInt::get(this->types["float"], std::stod(static_cast<AST::Literal*>(expr)->token.value));
-				}else if(literal->token.type == TokenType::literal_bool){
-					return llvm::ConstantInt::get(this->types["bool"], static_cast<AST::Literal*>(expr)->token.value == "true" ? 1 : 0);
+				auto literal = this->tree.get_token(expr);
+
+				if(literal.type == TokenType::literal_int){
+					return llvm::ConstantInt::get(this->llvm_types[types::type_int], ConstEvaluator::parse_int(literal.value));
+				}else if(literal.type == TokenType::literal_float){
+					return llvm::ConstantInt::get(this->llvm_types[types::type_float], ConstEvaluator::parse_float(literal.value));
+				}else if(literal.type == TokenType::literal_bool){
+					return llvm::ConstantInt::get(this->llvm_types[types::type_bool], literal.value == "true" ? 1 : 0);
 				}else{
-					cmd::fatal("Recieved unknown Literal type ({})", (int)expr->get_type());
+					cmd::fatal("Recieved unknown Literal type ({})", (int)expr.get_type());
 				}
 
 			} break;case AST::ExprType::Id: {
-				return this->global_llvm_vars[static_cast<AST::Id*>(expr)->token.value]->getInitializer();
+				// globals can be used before they're declared, so a global that isn't made yet is read from its declaration
+				auto symbol = this->tree.get_token(expr).symbol;
+				if(auto* global = this->global_llvm_vars.find(symbol); global != nullptr){
+					return (*global)->getInitializer();
+				}
+				return this->get_global_initializer(*this->global_vars.find(symbol));
+
+			} break;case AST::ExprType::FuncCall: {
+				auto& func_call = this->tree.get<AST::FuncCall>(expr);
+				const auto* folded = this->const_evaluator.get_folded(AST::Index<AST::FuncCall>(expr.index()));
+				if(folded == nullptr){
+					cmd::fatal("Recieved function call that couldn't be run at compile time for llvm_constant");
+					break;
+				}
+
+				auto return_type = this->tree.get(*this->functions.find(this->tree.get_token(func_call.id).symbol)).return_type_id;
+				return this->get_llvm_constant(return_type, *folded);
+
+			} break; default:cmd::fatal("Recieved unknown expr type llvm_constant ({})", (int)expr.get_type());
+		};
+
+		return nullptr;
+	};
+
 
-			} break; default:cmd::fatal("Recieved unknown expr type llvm_constant ({})", (int)expr->get_type());
+	// a value run at compile time by the ConstEvaluator
+	llvm::Constant* Compiler::get_llvm_constant(TypeId type, ConstEvaluator::Value value){
+		switch(type){
+			case types::type_int: return llvm::ConstantInt::get(this->llvm_types[types::type_int], value.int_value);
+			case types::type_float: return llvm::ConstantFP::get(this->llvm_types[types::type_float], value.float_value);
+			case types::type_bool: return llvm::ConstantInt::get(this->llvm_types[types::type_bool], value.bool_value ? 1 : 0);
+			default: cmd::fatal("Recieved folded value of unknown type ({})", this->types.print(type));
 		};
 
 		return nullptr;
@@ -433,42 +548,34 @@ namespace Hawk{
 	// scoping
 
 	void Compiler::enter_scope(){
-		this->scopes.emplace_back();
+		this->scopes.enter_scope();
 	};
 
 	void Compiler::leave_scope(){
-		this->scopes.pop_back();
+		this->scopes.leave_scope();
 	};
 
-	void Compiler::add_to_scope(std::string var_name, llvm::AllocaInst* alloca){
-		this->scopes.back()[var_name] = alloca;
+	void Compiler::add_to_scope(SymbolId var_name, llvm::AllocaInst* alloca){
+		this->scopes.add(var_name, alloca);
 	};
 
-	llvm::AllocaInst* Compiler::in_scope(const std::string& var_name){
-
-
-		for(std::list<Scope>::reverse_iterator ptr = this->scopes.rbegin(); ptr != this->scopes.rend(); ptr++){
-			auto scope = *ptr;
-			if(scope.contains(var_name)){
-				return scope[var_name];
-			}
+	llvm::AllocaInst* Compiler::in_scope(SymbolId var_name){
+		if(auto* alloca = this->scopes.find(var_name); alloca != nullptr){
+			return *alloca;
 		}
-
-
-
 		return nullptr;
 	};
 
-	llvm::AllocaInst* Compiler::in_current_scope(const std::string& var_name){
-		if(this->scopes.back().contains(var_name)){
-			return this->scopes.back()[var_name];
+	llvm::AllocaInst* Compiler::in_current_scope(SymbolId var_name){
+		if(auto* alloca = this->scopes.find_in_current_scope(var_name); alloca != nullptr){
+			return *alloca;
 		}
 		return nullptr;
 	};
 
 
 	bool Compiler::in_global_scope(){
-		return this->scopes.size() == 1;
+		return this->scopes.depth() == 1;
 	};
 
 
@@ -6,13 +6,17 @@
 
 
 #include "Parser.h"
+#include "ConstEvaluator.h"
 
 namespace Hawk{
 
 	class Compiler{
 			public:
-				Compiler(std::map<std::string, AST::VarDecl*>& global_vars, 
-					const std::map<std::string, AST::FuncDef*>& functions,
+				Compiler(const AST::Tree& ast,
+					const symbols::Map<AST::Index<AST::VarDecl>>& global_vars, 
+					const symbols::Map<AST::Index<AST::FuncDef>>& functions,
+					const types::Table& types,
+					const ConstEvaluator& const_evaluator,
 					const std::string& package_name);
 				~Compiler();
 
@@ -29,15 +33,22 @@ namespace Hawk{
 				void run_interpreter();
 
 			private:
-				llvm::Value* get_llvm_value(AST::Expr* expr);
-				llvm::Constant* get_llvm_constant(AST::Expr* expr);
+				llvm::Value* get_llvm_value(AST::Expr expr);
+				llvm::Value* get_llvm_binary(AST::Expr expr, llvm::Value* left, llvm::Value* right);
+				llvm::Constant* get_global_initializer(AST::Index<AST::VarDecl> var_decl);
+				llvm::Constant* get_llvm_constant(AST::Expr expr);
+				llvm::Constant* get_llvm_constant(TypeId type, ConstEvaluator::Value value);
 
-				void parse_stmt(AST::Stmt* stmt, AST::FuncDef* func_def);
+				void parse_stmt(AST::Stmt stmt);
+				void emit_stmt(AST::Stmt stmt);
 
 		
 			private:
-				std::map<std::string, AST::VarDecl*>& global_vars;
-				const std::map<std::string, AST::FuncDef*>& functions;
+				const AST::Tree& tree;
+				const symbols::Map<AST::Index<AST::VarDecl>>& global_vars;
+				const symbols::Map<AST::Index<AST::FuncDef>>& functions;
+				const types::Table& types;
+				const ConstEvaluator& const_evaluator;
 				// const std::string& package_name;
 
 
@@ -45,23 +56,42 @@ namespace Hawk{
 				llvm::IRBuilder<> builder;
 				llvm::Module module;
 
-				std::map<std::string, llvm::Type*> types;
-				std::map<std::string, llvm::GlobalVariable*> global_llvm_vars;
-				std::map<std::string, llvm::Function*> llvm_functions;
+				std::vector<llvm::Type*> llvm_types; // indexed by TypeId
+				symbols::Map<llvm::GlobalVariable*> global_llvm_vars;
+				symbols::Map<llvm::Function*> llvm_functions;
 
 
 				void enter_scope();
 				void leave_scope();
-				void add_to_scope(std::string var_name, llvm::AllocaInst* alloca);
-				llvm::AllocaInst* in_scope(const std::string& var_name);
-				llvm::AllocaInst* in_current_scope(const std::string& var_name);
+				void add_to_scope(SymbolId var_name, llvm::AllocaInst* alloca);
+				llvm::AllocaInst* in_scope(SymbolId var_name);
+				llvm::AllocaInst* in_current_scope(SymbolId var_name);
 				bool in_global_scope();
 
-				using Scope = std::map<std::string, llvm::AllocaInst*>;
-				std::list<Scope> scopes;
+				symbols::ScopedMap<llvm::AllocaInst*> scopes;
 
 
 				bool just_returned = false;
+
+
+				// explicit stacks of parse_stmt and get_llvm_value (kept to reuse their memory)
+				struct StmtWork{
+					enum class Kind{
+						stmt,
+						leave_scope,
+						end_then, // branch to merge_block, then emit else_block (if any)
+						end_else, // branch to merge_block
+					};
+
+					Kind kind;
+					AST::Stmt stmt{};
+					llvm::BasicBlock* else_block = nullptr;
+					llvm::BasicBlock* merge_block = nullptr;
+				};
+
+				std::vector<StmtWork> stmt_stack;
+				std::vector<std::pair<AST::Expr, bool>> expr_stack;
+				std::vector<llvm::Value*> value_stack;
 		};	
 
 };
@@ -0,0 +1,533 @@
+#include "pch.h"
+#include "ConstEvaluator.h"
+
+
+namespace Hawk{
+
+	int64_t ConstEvaluator::parse_int(std::string_view str){
+		int64_t output = 0;
+		std::from_chars(str.data(), str.data() + str.size(), output);
+		return output;
+	};
+
+	double ConstEvaluator::parse_float(std::string_view str){
+		double output = 0;
+		std::from_chars(str.data(), str.data() + str.size(), output);
+		return output;
+	};
+
+
+
+	// every call is tried, straight from the array of FuncCall nodes
+	// 	the arguments of a call are added to the tree before it, so a folded call is a constant in the arguments of the calls around it
+	// 	functions are only compiled when they're first called
+	void ConstEvaluator::fold_calls(){
+		this->compiled.assign(this->tree.all<AST::FuncDef>().size(), Function{});
+		this->folded.assign(this->tree.all<AST::FuncCall>().size(), Folded{});
+		this->outcomes.clear();
+		this->total_steps = 0;
+
+		for(uint32_t i = 0; i < this->folded.size(); i++){
+			this->fold(AST::Index<AST::FuncCall>(i));
+		}
+	};
+
+
+	void ConstEvaluator::fold(AST::Index<AST::FuncCall> func_call){
+		const auto* func_def = this->functions.find(this->tree.get_token(this->tree.get(func_call).id).symbol);
+		if(func_def == nullptr || this->tree.get(*func_def).return_type_id == types::type_void){ return; }
+
+		const auto code_size = this->code.size();
+		const auto constants_size = this->constants.size();
+
+		this->compile_func_call(func_call);
+		this->emit(Op::ret);
+		const auto code_end = this->code.size();
+
+		// an argument that reads a variable (or can't be run) compiles to a fail
+		auto thunk = std::span(this->code).subspan(code_size);
+		bool can_run = std::none_of(thunk.begin(), thunk.end(), [](const Instruction& instruction){ return instruction.op == Op::fail; });
+
+		auto value = Value{};
+		if(can_run && this->run(uint32_t(code_size), value)){
+			this->folded[func_call.value] = Folded(value, true);
+		}
+
+		// kept if a function was compiled after it
+		if(this->code.size() == code_end){
+			this->code.resize(code_size);
+			this->constants.resize(constants_size);
+		}
+	};
+
+
+
+	//////////////////////////////////////////////////////////////////////
+	// compiling
+
+	void ConstEvaluator::compile_function(AST::Index<AST::FuncDef> func_def){
+		auto& func_def_node = this->tree.get(func_def);
+		auto& function = this->compiled[func_def.value];
+
+		function.start = uint32_t(this->code.size());
+		function.param_count = func_def_node.params.size;
+		this->local_count = 0;
+
+		this->scopes.enter_scope();
+
+			for(auto& param : this->tree.get(func_def_node.params)){
+				this->scopes.add(this->tree.get_token(param.id).symbol, Local(this->local_count++, param.type_id));
+			}
+
+			for(auto stmt : this->tree.get(this->tree.get(func_def_node.block).stmts)){
+				this->compile_stmt(stmt);
+			}
+
+		this->scopes.leave_scope();
+
+		// only void functions can get to the end (the SemanticAnalyzer checks that the others return)
+		this->emit(func_def_node.return_type_id == types::type_void ? Op::ret_void : Op::fail);
+		function.local_count = this->local_count;
+	};
+
+
+	// walks the statement with an explicit stack (like Compiler::parse_stmt()), so deeply nested conditionals can't overflow the call stack
+	void ConstEvaluator::compile_stmt(AST::Stmt stmt){
+		auto& stack = this->stmt_stack;
+		stack.push_back(StmtWork(StmtWork::Kind::stmt, stmt));
+
+		while(!stack.empty()){
+			auto work = stack.back();
+			stack.pop_back();
+
+			switch(work.kind){
+				case StmtWork::Kind::stmt: switch(work.stmt.get_type()){
+					case AST::StmtType::VarDecl: {
+						auto& var_decl = this->tree.get<AST::VarDecl>(work.stmt);
+						if(var_decl.value.is_none()){ this->emit(Op::fail); break; }
+
+						this->compile_expr(var_decl.value);
+						const uint32_t slot = this->local_count++;
+						this->emit(Op::store, slot);
+						this->scopes.add(this->tree.get_token(var_decl.id).symbol, Local(slot, var_decl.type_id));
+
+					} break; case AST::StmtType::VarAssign: {
+						auto& var_assign = this->tree.get<AST::VarAssign>(work.stmt);
+
+						// not a local, so a global
+						const auto* local = this->scopes.find(this->tree.get_token(var_assign.id).symbol);
+						if(local == nullptr){ this->emit(Op::fail); break; }
+
+						this->compile_expr(var_assign.value);
+						this->emit(Op::store, local->slot);
+
+					} break; case AST::StmtType::FuncCallStmt: {
+						auto return_type = this->compile_func_call(this->tree.get<AST::FuncCallStmt>(work.stmt).expr);
+						if(return_type != types::type_void){ this->emit(Op::pop); }
+
+					} break; case AST::StmtType::ReturnStmt: {
+						auto& return_stmt = this->tree.get<AST::ReturnStmt>(work.stmt);
+
+						if(return_stmt.expr.is_none()){
+							this->emit(Op::ret_void);
+						}else{
+							this->compile_expr(return_stmt.expr);
+							this->emit(Op::ret);
+						}
+
+					} break; case AST::StmtType::Block: {
+						auto block_stmts = this->tree.get(this->tree.get<AST::Block>(work.stmt).stmts);
+
+						this->scopes.enter_scope();
+						stack.push_back(StmtWork(StmtWork::Kind::leave_scope));
+						for(auto block_stmt = block_stmts.rbegin(); block_stmt != block_stmts.rend(); block_stmt++){
+							stack.push_back(StmtWork(StmtWork::Kind::stmt, *block_stmt));
+						}
+
+					} break; case AST::StmtType::Conditional: {
+						auto& conditional = this->tree.get<AST::Conditional>(work.stmt);
+						this->compile_expr(conditional.cond);
+
+						const auto jump_to_else = uint32_t(this->code.size());
+						this->emit(Op::jump_if_false);
+
+						stack.push_back(StmtWork(StmtWork::Kind::end_then, work.stmt, jump_to_else));
+						stack.push_back(StmtWork(StmtWork::Kind::stmt, conditional.then_block));
+
+					} break; default: {
+						this->emit(Op::fail);
+					} break;
+
+				} break; case StmtWork::Kind::leave_scope: {
+					this->scopes.leave_scope();
+
+				} break; case StmtWork::Kind::end_then: {
+					auto& conditional = this->tree.get<AST::Conditional>(work.stmt);
+
+					if(conditional.else_block.is_none()){
+						this->code[work.jump].operand = uint32_t(this->code.size());
+						break;
+					}
+
+					const auto jump_to_end = uint32_t(this->code.size());
+					this->emit(Op::jump);
+					this->code[work.jump].operand = uint32_t(this->code.size());
+
+					stack.push_back(StmtWork(StmtWork::Kind::end_else, work.stmt, jump_to_end));
+					stack.push_back(StmtWork(StmtWork::Kind::stmt, conditional.else_block));
+
+				} break; case StmtWork::Kind::end_else: {
+					this->code[work.jump].operand = uint32_t(this->code.size());
+				} break;
+			};
+		};
+	};
+
+
+	// none if what it compiled fails when run
+	TypeId ConstEvaluator::compile_expr(AST::Expr expr){
+		switch(expr.get_type()){
+			case AST::ExprType::Literal: {
+				auto literal = this->tree.get_token(expr);
+				auto value = Value{};
+				auto type = types::none;
+
+				switch(literal.type){
+					case TokenType::literal_int:   value.int_value = parse_int(literal.value); type = types::type_int; break;
+					case TokenType::literal_float: value.float_value = parse_float(literal.value); type = types::type_float; break;
+					case TokenType::literal_bool:  value.bool_value = literal.value == "true"; type = types::type_bool; break;
+					default: this->emit(Op::fail); return types::none;
+				};
+
+				this->emit(Op::push, uint32_t(this->constants.size()));
+				this->constants.push_back(value);
+				return type;
+
+			} break; case AST::ExprType::Id: {
+				// not a local, so a global
+				const auto* local = this->scopes.find(this->tree.get_token(expr).symbol);
+				if(local == nullptr){
+					this->emit(Op::fail);
+					return types::none;
+				}
+
+				this->emit(Op::load, local->slot);
+				return local->type;
+
+			} break; case AST::ExprType::FuncCall: {
+				return this->compile_func_call(AST::Index<AST::FuncCall>(expr.index()));
+
+			} break; case AST::ExprType::Binary: {
+				// operands are visited with an explicit stack, like in Compiler::get_llvm_value()
+				size_t expr_start = this->expr_stack.size();
+				size_t type_start = this->type_stack.size();
+
+				this->expr_stack.emplace_back(expr, false);
+
+				while(this->expr_stack.size() > expr_start){
+					auto [current, visited] = this->expr_stack.back();
+					this->expr_stack.pop_back();
+
+					if(current.get_type() != AST::ExprType::Binary){
+						auto type = this->compile_expr(current);
+						this->type_stack.push_back(type);
+
+					}else if(!visited){
+						auto& binary = this->tree.get<AST::Binary>(current);
+						this->expr_stack.emplace_back(current, true);
+						this->expr_stack.emplace_back(binary.right, false);
+						this->expr_stack.emplace_back(binary.left, false);
+
+					}else{
+						auto right = this->type_stack.back();
+						this->type_stack.pop_back();
+						auto& left = this->type_stack.back();
+
+						// (the SemanticAnalyzer doesn't type every binary, so the result type is found here)
+						auto op = left == right ? this->get_binary_op(current, left) : Op::fail;
+						this->emit(op);
+
+						if(op == Op::fail){
+							left = types::none;
+						}else if(!is_arithmetic(op)){
+							left = types::type_bool;
+						}
+					}
+				};
+
+				auto output = this->type_stack.back();
+				this->type_stack.resize(type_start);
+				return output;
+			} break;
+		};
+
+		this->emit(Op::fail);
+		return types::none;
+	};
+
+
+	TypeId ConstEvaluator::compile_func_call(AST::Index<AST::FuncCall> func_call){
+		auto& func_call_node = this->tree.get(func_call);
+		auto func_name = this->tree.get_token(func_call_node.id).symbol;
+
+		// printf prints
+		const auto* func_def = this->functions.find(func_name);
+		if(func_name == symbols::func_printf || func_def == nullptr){
+			this->emit(Op::fail);
+			return types::none;
+		}
+
+		auto return_type = this->tree.get(*func_def).return_type_id;
+
+		if(const auto* value = this->get_folded(func_call); value != nullptr){
+			this->emit(Op::push, uint32_t(this->constants.size()));
+			this->constants.push_back(*value);
+			return return_type;
+		}
+
+
+		// the arguments of calls in expressions aren't checked by the SemanticAnalyzer
+		auto params = this->tree.get(this->tree.get(*func_def).params);
+		auto args = this->tree.get(func_call_node.params);
+		bool args_match = args.size() == params.size();
+
+		for(size_t i = 0; i < args.size(); i++){
+			auto arg_type = this->compile_expr(args[i]);
+			args_match = args_match && arg_type == params[i].type_id;
+		}
+		this->emit(args_match ? Op::call : Op::fail, func_def->value);
+		return return_type;
+	};
+
+
+	auto ConstEvaluator::get_binary_op(AST::Expr expr, TypeId operand_type) const -> Op {
+		auto op = this->tree.tokens.kind(this->tree.get<AST::Binary>(expr).op);
+
+		switch(operand_type){
+			case types::type_int: switch(op){
+				case TokenType::op_plus:  return Op::add_int;
+				case TokenType::op_minus: return Op::sub_int;
+				case TokenType::op_mult:  return Op::mul_int;
+				case TokenType::op_div:   return Op::div_int;
+
+				case TokenType::op_lt:  return Op::lt_int;
+				case TokenType::op_lte: return Op::lte_int;
+				case TokenType::op_gt:  return Op::gt_int;
+				case TokenType::op_gte: return Op::gte_int;
+				case TokenType::op_eq:  return Op::eq_int;
+				case TokenType::op_neq: return Op::neq_int;
+				default: return Op::fail;
+			};
+
+			case types::type_float: switch(op){
+				case TokenType::op_plus:  return Op::add_float;
+				case TokenType::op_minus: return Op::sub_float;
+				case TokenType::op_mult:  return Op::mul_float;
+				case TokenType::op_div:   return Op::div_float;
+
+				case TokenType::op_lt:  return Op::lt_float;
+				case TokenType::op_lte: return Op::lte_float;
+				case TokenType::op_gt:  return Op::gt_float;
+				case TokenType::op_gte: return Op::gte_float;
+				case TokenType::op_eq:  return Op::eq_float;
+				case TokenType::op_neq: return Op::neq_float;
+				default: return Op::fail;
+			};
+
+			case types::type_bool: switch(op){
+				case TokenType::op_eq:  return Op::eq_bool;
+				case TokenType::op_neq: return Op::neq_bool;
+				case TokenType::op_and: return Op::and_bool;
+				case TokenType::op_or:  return Op::or_bool;
+				default: return Op::fail;
+			};
+
+			default: return Op::fail;
+		};
+	};
+
+
+
+	//////////////////////////////////////////////////////////////////////
+	// running
+
+	// false if it failed or went past the limits
+	// 	a call that fails is kept as failed, so calls with the same arguments fail right away
+	bool ConstEvaluator::run(uint32_t start, Value& output){
+		this->running_call.clear();
+
+		bool ran = this->execute(start, output);
+		if(!ran && !this->running_call.empty()){
+			this->outcomes.emplace(std::move(this->running_call), Folded{});
+		}
+
+		return ran;
+	};
+
+
+	// the arguments of a call of the thunk are the top values of the stack
+	// 	they're compared by value, so a bool only keeps its bool_value (the other bytes of the union aren't set)
+	std::vector<uint64_t> ConstEvaluator::get_call_key(uint32_t func_def) const {
+		const auto params = this->tree.get(this->tree.get(AST::Index<AST::FuncDef>(func_def)).params);
+		const auto args = std::span(this->stack).last(params.size());
+
+		auto key = std::vector<uint64_t>();
+		key.reserve(params.size() + 1);
+		key.push_back(func_def);
+
+		for(size_t i = 0; i < params.size(); i++){
+			key.push_back(params[i].type_id == types::type_bool ? uint64_t(args[i].bool_value) : uint64_t(args[i].int_value));
+		}
+
+		return key;
+	};
+
+
+	// the results match what the Compiler emits (ints wrap, float compares are ordered), division by zero is left to runtime
+	// 	the step limit is for each call of the thunk (the thunk itself only pushes the arguments)
+	bool ConstEvaluator::execute(uint32_t start, Value& output){
+		auto& stack = this->stack;
+		auto& frames = this->frames;
+		stack.clear();
+		frames.clear();
+
+		uint32_t pc = start;
+		uint32_t base = 0; // of the locals of the current call
+		uint32_t steps = 0;
+
+		for(; steps < max_steps && this->total_steps < max_total_steps; steps++, this->total_steps++){
+			const auto instruction = this->code[pc++];
+
+			if(instruction.op >= Op::add_int && instruction.op <= Op::or_bool){
+				const auto right = stack.back();
+				stack.pop_back();
+				auto& left = stack.back();
+
+				switch(instruction.op){
+					case Op::add_int: left.int_value = int64_t(uint64_t(left.int_value) + uint64_t(right.int_value)); break;
+					case Op::sub_int: left.int_value = int64_t(uint64_t(left.int_value) - uint64_t(right.int_value)); break;
+					case Op::mul_int: left.int_value = int64_t(uint64_t(left.int_value) * uint64_t(right.int_value)); break;
+					case Op::div_int: {
+						if(right.int_value == 0 || (right.int_value == -1 && left.int_value == std::numeric_limits<int64_t>::min())){ return false; }
+						left.int_value /= right.int_value;
+					} break;
+
+					case Op::lt_int:  left = Value{.bool_value = left.int_value <  right.int_value}; break;
+					case Op::lte_int: left = Value{.bool_value = left.int_value <= right.int_value}; break;
+					case Op::gt_int:  left = Value{.bool_value = left.int_value >  right.int_value}; break;
+					case Op::gte_int: left = Value{.bool_value = left.int_value >= right.int_value}; break;
+					case Op::eq_int:  left = Value{.bool_value = left.int_value == right.int_value}; break;
+					case Op::neq_int: left = Value{.bool_value = left.int_value != right.int_value}; break;
+
+					case Op::add_float: left.float_value += right.float_value; break;
+					case Op::sub_float: left.float_value -= right.float_value; break;
+					case Op::mul_float: left.float_value *= right.float_value; break;
+					case Op::div_float: left.float_value /= right.float_value; break;
+
+					case Op::lt_float:  left = Value{.bool_value = left.float_value <  right.float_value}; break;
+					case Op::lte_float: left = Value{.bool_value = left.float_value <= right.float_value}; break;
+					case Op::gt_float:  left = Value{.bool_value = left.float_value >  right.float_value}; break;
+					case Op::gte_float: left = Value{.bool_value = left.float_value >= right.float_value}; break;
+					case Op::eq_float:  left = Value{.bool_value = left.float_value == right.float_value}; break;
+					case Op::neq_float: left = Value{.bool_value = left.float_value < right.float_value || left.float_value > right.float_value}; break;
+
+					case Op::eq_bool:  left.bool_value = left.bool_value == right.bool_value; break;
+					case Op::neq_bool: left.bool_value = left.bool_value != right.bool_value; break;
+					case Op::and_bool: left.bool_value = left.bool_value && right.bool_value; break;
+					case Op::or_bool:  left.bool_value = left.bool_value || right.bool_value; break;
+
+					default: return false;
+				};
+
+				continue;
+			}
+
+
+			switch(instruction.op){
+				case Op::push: {
+					stack.push_back(this->constants[instruction.operand]);
+
+				} break; case Op::load: {
+					const auto value = stack[base + instruction.operand];
+					stack.push_back(value);
+
+				} break; case Op::store: {
+					stack[base + instruction.operand] = stack.back();
+					stack.pop_back();
+
+				} break; case Op::pop: {
+					stack.pop_back();
+
+				} break; case Op::jump: {
+					pc = instruction.operand;
+
+				} break; case Op::jump_if_false: {
+					const bool condition = stack.back().bool_value;
+					stack.pop_back();
+					if(!condition){ pc = instruction.operand; }
+
+				} break; case Op::call: {
+					if(frames.size() == max_depth){ return false; }
+
+					// a call of the thunk, one with the same arguments already ran
+					if(frames.empty()){
+						auto key = this->get_call_key(instruction.operand);
+						if(auto outcome = this->outcomes.find(key); outcome != this->outcomes.end()){
+							if(!outcome->second.is_folded){ return false; }
+
+							stack.resize(stack.size() - this->tree.get(AST::Index<AST::FuncDef>(instruction.operand)).params.size);
+							stack.push_back(outcome->second.value);
+							break;
+						}
+
+						this->running_call = std::move(key);
+						steps = 0;
+					}
+
+					if(this->compiled[instruction.operand].start == Function::not_compiled){
+						this->compile_function(AST::Index<AST::FuncDef>(instruction.operand));
+					}
+
+					// the arguments become the first locals
+					const auto& function = this->compiled[instruction.operand];
+					frames.push_back(Frame(pc, base));
+					base = uint32_t(stack.size() - function.param_count);
+					stack.resize(base + function.local_count);
+					pc = function.start;
+
+				} break; case Op::ret: {
+					const auto result = stack.back();
+					if(frames.empty()){
+						output = result;
+						return true;
+					}
+
+					stack.resize(base);
+					stack.push_back(result);
+					pc = frames.back().return_to;
+					base = frames.back().base;
+					frames.pop_back();
+
+					if(frames.empty()){
+						this->outcomes.emplace(std::move(this->running_call), Folded(result, true));
+						this->running_call.clear();
+					}
+
+				} break; case Op::ret_void: {
+					if(frames.empty()){ return false; }
+
+					stack.resize(base);
+					pc = frames.back().return_to;
+					base = frames.back().base;
+					frames.pop_back();
+
+				} break; default: {
+					return false;
+				} break;
+			};
+		}
+
+		return false;
+	};
+
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "Parser.h"
+
+namespace Hawk{
+
+	// runs calls to functions that only compute (int / float / bool math, conditionals, calls, recursion) at compile time
+	// 	function bodies are compiled to a small stack bytecode, and every call whose arguments are constant is run on it
+	// 	a call that reads or assigns a global, calls printf, divides by zero or goes past the limits is just left to run at runtime
+	// 	the outcome of a call (failed or not) is kept by function and argument values, the same call isn't run twice
+	class ConstEvaluator{
+		public:
+			union Value{
+				int64_t int_value;
+				double float_value;
+				bool bool_value;
+			};
+
+			// for each call that is run (past them, the call is left to runtime)
+			static constexpr uint32_t max_steps = 1 << 22;
+			static constexpr uint32_t max_depth = 1024;
+
+			// for all the calls of a compile, past it nothing more is folded
+			static constexpr uint64_t max_total_steps = 1 << 26;
+
+		public:
+			ConstEvaluator(const AST::Tree& ast, const symbols::Map<AST::Index<AST::FuncDef>>& functions) : tree(ast), functions(functions) {};
+			~ConstEvaluator() = default;
+
+			// the tree must be through the SemanticAnalyzer without errors
+			void fold_calls();
+
+			// nullptr if the call isn't folded
+			inline const Value* get_folded(AST::Index<AST::FuncCall> func_call) const {
+				if(func_call.value >= this->folded.size() || !this->folded[func_call.value].is_folded){ return nullptr; }
+				return &this->folded[func_call.value].value;
+			};
+
+			// literal tokens are views into the source, so they're parsed in place
+			static int64_t parse_int(std::string_view str);
+			static double parse_float(std::string_view str);
+
+		private:
+			enum class Op : uint8_t {
+				push,  // constants[operand]
+				load,  // local slot `operand`
+				store, // pops into local slot `operand`
+				pop,
+
+				// binary ops (add_int to or_bool) pop the right operand and replace the left one
+				add_int, sub_int, mul_int, div_int,
+				lt_int, lte_int, gt_int, gte_int, eq_int, neq_int,
+
+				add_float, sub_float, mul_float, div_float,
+				lt_float, lte_float, gt_float, gte_float, eq_float, neq_float,
+
+				eq_bool, neq_bool, and_bool, or_bool,
+
+				jump,          // to `operand`
+				jump_if_false, // pops the condition
+				call,          // the function of the FuncDef at index `operand` (its arguments are on the stack)
+				ret,
+				ret_void,
+
+				fail, // the call can't be evaluated at compile time
+			};
+
+			struct Instruction{
+				Op op;
+				uint32_t operand = 0;
+			};
+
+			struct Function{
+				static constexpr uint32_t not_compiled = ~uint32_t(0);
+
+				uint32_t start = not_compiled;
+				uint32_t param_count = 0;
+				uint32_t local_count = 0; // params included
+			};
+
+			struct Local{
+				uint32_t slot;
+				TypeId type;
+			};
+
+			struct Folded{
+				Value value{};
+				bool is_folded = false;
+			};
+
+
+			void compile_function(AST::Index<AST::FuncDef> func_def);
+			void compile_stmt(AST::Stmt stmt);
+			TypeId compile_expr(AST::Expr expr);
+			TypeId compile_func_call(AST::Index<AST::FuncCall> func_call);
+			Op get_binary_op(AST::Expr expr, TypeId operand_type) const;
+
+			void fold(AST::Index<AST::FuncCall> func_call);
+			bool run(uint32_t start, Value& output);
+			bool execute(uint32_t start, Value& output);
+			std::vector<uint64_t> get_call_key(uint32_t func_def) const;
+
+			static inline bool is_arithmetic(Op op){
+				return (op >= Op::add_int && op <= Op::div_int) || (op >= Op::add_float && op <= Op::div_float);
+			};
+
+			inline void emit(Op op, uint32_t operand = 0){
+				this->code.push_back(Instruction(op, operand));
+			};
+
+		private:
+			const AST::Tree& tree;
+			const symbols::Map<AST::Index<AST::FuncDef>>& functions;
+
+			std::vector<Instruction> code;
+			std::vector<Value> constants;
+			std::vector<Function> compiled; // indexed by FuncDef index
+
+			std::vector<Folded> folded; // indexed by FuncCall index
+
+			// the function (FuncDef index) then the argument values
+			std::map<std::vector<uint64_t>, Folded> outcomes;
+			std::vector<uint64_t> running_call; // the call of outcomes that's running (empty if none)
+			uint64_t total_steps = 0;
+
+
+			// compiling
+			symbols::ScopedMap<Local> scopes;
+			uint32_t local_count = 0;
+
+			struct StmtWork{
+				enum class Kind{
+					stmt,
+					leave_scope,
+					end_then, // jump over the else block (if any), then compile it
+					end_else,
+				};
+
+				Kind kind;
+				AST::Stmt stmt{};
+				uint32_t jump = 0; // instruction to point at the end of the block
+			};
+
+			std::vector<StmtWork> stmt_stack;
+			std::vector<std::pair<AST::Expr, bool>> expr_stack;
+			std::vector<TypeId> type_stack;
+
+
+			// running
+			struct Frame{
+				uint32_t return_to;
+				uint32_t base;
+			};
+
+			std::vector<Value> stack;
+			std::vector<Frame> frames;
+	};
+
+}
@@ -0,0 +1,235 @@
+#include "pch.h"
+#include "Diagnostics.h"
+
+
+namespace Hawk{
+
+	struct Message{
+		Diagnostics::Severity severity;
+		const char* text; // lines are split by '\n', `{}` is the next argument
+	};
+
+	static Message get_message(Diagnostics::Code code){
+		using Code = Diagnostics::Code;
+		using Severity = Diagnostics::Severity;
+
+		switch(code){
+			case Code::global_var_redefined:        return {Severity::error, "\tGlobal variable ({}) was already defined at {}"};
+			case Code::function_redefined:          return {Severity::error, "\tFunction ({}) was already defined at {}"};
+			case Code::var_assign_in_global_scope:  return {Severity::error, "\tVariable assignments cannot be in global scope"};
+			case Code::func_call_in_global_scope:   return {Severity::error, "\tFunction-call statements cannot be in global scope"};
+			case Code::block_in_global_scope:       return {Severity::error, "\tBlock statements cannot be alone in global scope"};
+			case Code::return_in_global_scope:      return {Severity::error, "\tReturn statements cannot be in global scope"};
+			case Code::conditional_in_global_scope: return {Severity::error, "\tConditional statements cannot be in global scope"};
+			case Code::global_value_not_constant:   return {Severity::error, "\tThe value of global variable ({}) can't be computed at compile time\n\tIt can be a literal, another global or a call that only computes, with constant arguments"};
+
+			case Code::self_declaration:       return {Severity::error,   "\tCannot set variable to self in a declaration"};
+			case Code::param_redefined:        return {Severity::error,   "\tParameter({}) was already defined at {} "};
+			case Code::param_shadows:          return {Severity::warning, "\tParameter ({}) was already defined in a parent scope at {} \n\tThis may cause unexpected behavior"};
+			case Code::var_redefined:          return {Severity::error,   "\tVariable ({}) was already defined at {} "};
+			case Code::var_shadows:            return {Severity::warning, "\tVariable ({}) was already defined in a parent scope at {} \n\tThis may cause unexpected behavior"};
+			case Code::var_decl_type_mismatch: return {Severity::error,   "\tType mismatch in definition of variable ({})\n\t{ {} : ({}) = ({}) }"};
+			case Code::assign_undefined_var:   return {Severity::error,   "\tAssignment of undefined variable ({})"};
+			case Code::assign_type_mismatch:   return {Severity::error,   "\tIncorrect expression type in assignment of variable ({})\n\texpected ({}), recieved ({})"};
+
+			case Code::return_in_void_function: return {Severity::error,   "\tFound return statement in function ({}) with 'void' return type"};
+			case Code::missing_return:          return {Severity::error,   "\tFunction ({}) does not return on all conditional paths"};
+			case Code::code_after_return:       return {Severity::error,   "\tFound code after return stmt"};
+			case Code::unknown_return_type:     return {Severity::warning, "\tUnable to determine type of return statement in function ({})"};
+			case Code::return_type_mismatch:    return {Severity::error,   "\tUnmatching return types (func: {}, return: {})"};
+			case Code::nested_function:         return {Severity::error,   "\tFunction definitions must be in global scope\n\tThey must be outside all functions"};
+			case Code::condition_not_bool:      return {Severity::error,   "\tConditional expressions must return type 'bool'"};
+
+			case Code::undefined_function: return {Severity::error, "\tFunction ({}) is not defined"};
+			case Code::wrong_arg_count:    return {Severity::error, "\tInvalid number of function call arguments\n\tFunction ({}) has ({}) arguments, recieved ({})"};
+			case Code::wrong_arg_type:     return {Severity::error, "\tIncorrect function argument type in function ({})\n\tArgument ({}/{}) is ({}), recieved ({})"};
+			case Code::printf_not_checked: return {Severity::note,  "Semantic Analyzer not run on arguments to printf (may cause compilation errors/seg-faults)"};
+
+			case Code::undefined_variable: return {Severity::error, "\tVariable ({}) is not defined"};
+			case Code::untyped_variable:   return {Severity::error, "\tVariable ({}) doesn't have a type"};
+			case Code::type_cycle:         return {Severity::error, "\tThe type of ({}) depends on itself"};
+			case Code::invalid_binary:     return {Severity::error, "\tBinary expression is invalid\n\t[ ({}) {} ({}) ]"};
+
+			case Code::unknown_literal:    return {Severity::error, "\tCompiler Fail: Received unknown literal type ({})"};
+			case Code::unknown_statement:  return {Severity::error, "\tCompiler Fail: Received unknown statement type (SemanticAnalyzer, line: {})"};
+			case Code::unknown_expression: return {Severity::error, "\tCompiler Fail: Received unknown expression type (SemanticAnalyzer, line: {})"};
+			case Code::unknown_binary_op:  return {Severity::error, "\tCompiler Fail: Received unknown binary operation type (SemanticAnalyzer, line: {})"};
+		};
+
+		return {Severity::error, "\tCompiler Fail: unknown diagnostic"};
+	};
+
+
+	auto Diagnostics::get_severity(Code code) -> Severity {
+		return get_message(code).severity;
+	};
+
+
+	auto Diagnostics::make(Code code, const Tokenizer::Token* token, std::initializer_list<Argument> arguments) -> Diagnostic {
+		auto diagnostic = Diagnostic{code, false};
+
+		if(token != nullptr){
+			diagnostic.has_snippet = token->type != TokenType::generated;
+			diagnostic.position = token->position;
+			diagnostic.size = uint32_t(token->value.size());
+		}
+
+		std::copy_n(arguments.begin(), std::min(arguments.size(), max_arguments), diagnostic.arguments.begin());
+		return diagnostic;
+	};
+
+
+
+	void Diagnostics::report(const Diagnostic& diagnostic){
+		this->append(std::span(&diagnostic, 1));
+	};
+
+	void Diagnostics::append(std::span<const Diagnostic> diagnostics){
+		if(diagnostics.empty()){ return; }
+
+		const auto lock = std::scoped_lock(this->mutex);
+
+		for(const auto& diagnostic : diagnostics){
+			switch(get_severity(diagnostic.code)){
+				case Severity::error:   this->error_count += 1; break;
+				case Severity::warning: this->warning_count += 1; break;
+				case Severity::note:    break;
+			};
+		}
+
+		this->diagnostics.insert(this->diagnostics.end(), diagnostics.begin(), diagnostics.end());
+	};
+
+
+	uint Diagnostics::get_error_count() const {
+		const auto lock = std::scoped_lock(this->mutex);
+		return this->error_count;
+	};
+
+	uint Diagnostics::get_warning_count() const {
+		const auto lock = std::scoped_lock(this->mutex);
+		return this->warning_count;
+	};
+
+
+
+	void Diagnostics::print(){
+		const auto lock = std::scoped_lock(this->mutex);
+
+		auto output = std::string();
+		uint hidden_errors = 0;
+		uint hidden_warnings = 0;
+
+		for(; this->printed < this->diagnostics.size(); this->printed++){
+			const auto& diagnostic = this->diagnostics[this->printed];
+
+			switch(get_severity(diagnostic.code)){
+				case Severity::error: {
+					if(this->max_errors != 0 && this->printed_errors == this->max_errors){ hidden_errors += 1; continue; }
+					this->printed_errors += 1;
+				} break;
+
+				case Severity::warning: {
+					if(this->max_warnings != 0 && this->printed_warnings == this->max_warnings){ hidden_warnings += 1; continue; }
+					this->printed_warnings += 1;
+				} break;
+
+				case Severity::note: break;
+			};
+
+			this->render(output, diagnostic);
+		}
+
+		if(hidden_errors != 0 || hidden_warnings != 0){
+			auto line = fmt::format("\n({} more errors and {} more warnings not shown)", hidden_errors, hidden_warnings);
+			if(cmd::using_color()){ output += cmd::Style::log; }
+			output += line;
+			output += "\x1b[0m\n\x1b[0m";
+		}
+
+		cmd::out_captured(output);
+	};
+
+
+
+	// the same text cmd::error() / cmd::warning() print, line by line
+	void Diagnostics::render(std::string& output, const Diagnostic& diagnostic) const {
+		auto message = get_message(diagnostic.code);
+		const char* style = message.severity == Severity::error ? cmd::Style::error : cmd::Style::warning;
+		const bool use_color = cmd::using_color();
+
+		auto begin_line = [&](){
+			if(use_color){ output += style; }
+		};
+		auto end_line = [&](){
+			output += "\x1b[0m\n\x1b[0m";
+		};
+
+
+		if(diagnostic.position != no_position){
+			begin_line();
+			output += message.severity == Severity::error ? "\nERROR: " : "\nWARNING: ";
+			output += this->print_location(diagnostic.position, diagnostic.size);
+			end_line();
+
+			if(diagnostic.has_snippet){
+				const auto& file = this->files.find(diagnostic.position);
+				begin_line();
+				output += file.stream->get_snippet(diagnostic.position - file.start, diagnostic.size);
+				end_line();
+			}
+		}
+
+
+		size_t next_argument = 0;
+		begin_line();
+
+		for(const char* str = message.text; *str != '\0'; str++){
+			if(*str == '\n'){
+				end_line();
+				begin_line();
+				continue;
+			}
+
+			if(str[0] != '{' || str[1] != '}'){
+				output += *str;
+				continue;
+			}
+
+			str += 1;
+			const auto& argument = diagnostic.arguments[next_argument++];
+
+			switch(argument.kind){
+				case Argument::Kind::text: {
+					output.append(argument.text, argument.size);
+				} break;
+
+				case Argument::Kind::number: {
+					char digits[24];
+					auto result = std::to_chars(std::begin(digits), std::end(digits), argument.number);
+					output.append(digits, result.ptr);
+				} break;
+
+				case Argument::Kind::location: {
+					output += this->print_location(argument.position, argument.size);
+				} break;
+			};
+		}
+
+		end_line();
+	};
+
+
+	std::string Diagnostics::print_location(uint position, uint32_t size) const {
+		// found from the start, the end of a token can be the start of the next file
+		const auto& file = this->files.find(position);
+		auto location = file.stream->get_location(position + size - file.start);
+
+		if(this->files.size() > 1){
+			return fmt::format("{} <{}, {}>", file.path.string(), location.line, location.collumn);
+		}
+
+		return fmt::format("<{}, {}>", location.line, location.collumn);
+	};
+
+}
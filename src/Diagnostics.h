@@ -0,0 +1,144 @@
+#pragma once
+
+#include "CharacterStream.h"
+#include "Tokenizer.h"
+
+namespace Hawk{
+
+	// the errors and warnings of the SemanticAnalyzer
+	// 	kept as small records (a code, where it is and the arguments of its message) and only turned into text by print()
+	// 	report() and append() can be called from any thread
+	class Diagnostics{
+		public:
+			enum class Severity : uint8_t {
+				error,
+				warning,
+				note, // a line without a location, not counted
+			};
+
+			enum class Code : uint8_t {
+				global_var_redefined,
+				function_redefined,
+				var_assign_in_global_scope,
+				func_call_in_global_scope,
+				block_in_global_scope,
+				return_in_global_scope,
+				conditional_in_global_scope,
+				global_value_not_constant,
+
+				self_declaration,
+				param_redefined,
+				param_shadows,
+				var_redefined,
+				var_shadows,
+				var_decl_type_mismatch,
+				assign_undefined_var,
+				assign_type_mismatch,
+
+				return_in_void_function,
+				missing_return,
+				code_after_return,
+				unknown_return_type,
+				return_type_mismatch,
+				nested_function,
+				condition_not_bool,
+
+				undefined_function,
+				wrong_arg_count,
+				wrong_arg_type,
+				printf_not_checked,
+
+				undefined_variable,
+				untyped_variable,
+				type_cycle,
+				invalid_binary,
+
+				unknown_literal,
+				unknown_statement,
+				unknown_expression,
+				unknown_binary_op,
+			};
+
+
+			// the location of a token, as an argument of a message
+			struct Location{
+				const Tokenizer::Token& token;
+			};
+
+			// text isn't copied (token values and type names, the sources and interner outlive the diagnostics)
+			struct Argument{
+				enum class Kind : uint8_t { text, number, location };
+
+				Argument() = default;
+				Argument(std::string_view str) : text(str.data()), size(uint32_t(str.size())), kind(Kind::text) {};
+				Argument(Location location) : position(location.token.position), size(uint32_t(location.token.value.size())), kind(Kind::location) {};
+
+				template<typename Int> requires std::is_integral_v<Int>
+				Argument(Int value) : number(uint64_t(value)), kind(Kind::number) {};
+
+				union{
+					const char* text = nullptr;
+					uint64_t number;
+					uint position;
+				};
+				uint32_t size = 0;
+				Kind kind = Kind::text;
+			};
+
+			static constexpr size_t max_arguments = 5;
+			static constexpr uint no_position = ~uint(0);
+
+			struct Diagnostic{
+				Code code;
+				bool has_snippet;
+				uint position = no_position; // of the token it points at, no_position if it has no location
+				uint32_t size = 0;
+				std::array<Argument, max_arguments> arguments{};
+			};
+
+
+		public:
+			Diagnostics(const SourceFiles& source_files) : files(source_files) {};
+			~Diagnostics() = default;
+
+			static Severity get_severity(Code code);
+
+			// `token` can be nullptr for a diagnostic without a location
+			static Diagnostic make(Code code, const Tokenizer::Token* token, std::initializer_list<Argument> arguments);
+
+			void report(const Diagnostic& diagnostic);
+			void append(std::span<const Diagnostic> diagnostics);
+
+			uint get_error_count() const;
+			uint get_warning_count() const;
+
+			// only the first `max_errors` errors and `max_warnings` warnings are printed (0 for no limit)
+			inline void set_limits(uint max_errors, uint max_warnings){
+				this->max_errors = max_errors;
+				this->max_warnings = max_warnings;
+			};
+
+			// renders what wasn't printed yet and writes it at once
+			void print();
+
+		private:
+			void render(std::string& output, const Diagnostic& diagnostic) const;
+			std::string print_location(uint position, uint32_t size) const;
+
+		private:
+			const SourceFiles& files;
+			std::vector<Diagnostic> diagnostics{};
+			size_t printed = 0;
+
+			uint error_count = 0;
+			uint warning_count = 0;
+			uint printed_errors = 0;
+			uint printed_warnings = 0;
+
+			uint max_errors = 0;
+			uint max_warnings = 0;
+
+			mutable std::mutex mutex{};
+	};
+
+}
@@ -1,43 +1,204 @@
 #include "pch.h"
 #include "Parser.h"
 
+#include "CharacterStream.h"
+
 
 namespace Hawk{
 
-	Parser::Parser(const std::vector<Tokenizer::Token>& token_vector)
-		: tokens(token_vector) {
+	Parser::Parser(const Tokenizer::TokenBuffer& token_buffer, const CharacterStream& char_stream)
+		: tree(char_stream.get_file()), tokens(&token_buffer), stream(&char_stream) {};
+
+	Parser::Parser(Tokenizer& tokenizer)
+		: tree(tokenizer.get_stream().get_file()), stream(&tokenizer.get_stream()), tokenizer(&tokenizer) {};
+
+
+
+	void Parser::start(){
+		this->pull_tokens();
+
+		while(this->has_tokens() && this->success()){
+			this->parse_top_level_stmt();
+		};
+	};
+
+
+	void Parser::parse_top_level_stmt(){
+		auto span = StatementSpan{
+			.start = this->peek().position,
+			.first_token = AST::TokenIndex(this->tree.tokens.size()),
+		};
+
+		this->tree.statements.push_back(this->parse_stmt());
+
+		span.end = this->peek(-1).end();
+		span.end_token = AST::TokenIndex(this->tree.tokens.size());
+		this->statement_spans.push_back(span);
+	};
+
+
+
+	auto Parser::find_edit(std::string_view old_source, std::string_view new_source) -> Edit {
+		auto prefix = std::mismatch(old_source.begin(), old_source.end(), new_source.begin(), new_source.end()).first - old_source.begin();
 
+		auto max_suffix = std::min(old_source.size(), new_source.size()) - prefix;
+		auto suffix = std::mismatch(old_source.rbegin(), old_source.rbegin() + max_suffix, new_source.rbegin()).first - old_source.rbegin();
+
+		return Edit{
+			.start   = uint(prefix),
+			.old_end = uint(old_source.size() - suffix),
+			.new_end = uint(new_source.size() - suffix),
+		};
 	};
 
 
-	Parser::~Parser(){
-		for(auto* stmt : this->statements){
-			delete stmt;
+	void Parser::reparse(CharacterStream& char_stream, Edit edit){
+		auto tokenizer = Tokenizer(char_stream);
+		this->tokenizer = &tokenizer;
+		this->stream = &char_stream;
+		this->i = 0;
+		this->lexed = 0;
+
+		if(!this->success()){
+			this->has_errored = false;
+			this->tree = AST::Tree(char_stream.get_file());
+			this->statement_spans.clear();
+
+			this->start();
+			this->tokenizer = nullptr;
+			return;
 		}
-	}
 
+		const int offset = int(edit.new_end) - int(edit.old_end);
 
+		auto old_statements = std::exchange(this->tree.statements, {});
+		auto old_spans = std::exchange(this->statement_spans, {});
 
-	void Parser::start(){
-		while(this->i + 1 < tokens.size() && this->success()){
-			this->statements.push_back(this->parse_stmt());
+		// statements touched by the edit (one that ends right where the edit starts could be joined with it)
+		auto first = std::partition_point(old_spans.begin(), old_spans.end(), [&](const StatementSpan& span){ return span.end < edit.start; });
+		auto last = std::partition_point(first, old_spans.end(), [&](const StatementSpan& span){ return span.start <= edit.old_end; });
+
+		tokenizer.seek(first == old_spans.begin() ? 0 : std::prev(first)->end);
+		this->tree.tokens.set_source(char_stream.get_file());
+		this->pull_tokens();
+
+
+		// parse until a statement starts where one of the old statements after the edit (moved) started
+		// 	from there on the source is the same as before, so the rest of the old statements are kept
+		auto next = last;
+
+		while(this->has_tokens() && this->success()){
+			const auto position = this->peek().position;
+
+			while(next != old_spans.end() && next->start + offset < position){
+				next += 1;
+			};
+
+			if(next != old_spans.end() && next->start + offset == position){ break; }
+
+			this->parse_top_level_stmt();
 		};
+
+		if(!this->has_tokens()){
+			next = old_spans.end();
+		}
+
+		this->tokenizer = nullptr;
+
+
+		// splice the new statements in place of [first, next)
+		for(auto span = next; span != old_spans.end(); span++){
+			span->start += offset;
+			span->end += offset;
+			this->tree.tokens.move_positions(span->first_token, span->end_token, offset);
+		}
+
+		auto first_index = first - old_spans.begin();
+		auto next_index = next - old_spans.begin();
+
+		old_statements.erase(old_statements.begin() + first_index, old_statements.begin() + next_index);
+		old_statements.insert(old_statements.begin() + first_index, this->tree.statements.begin(), this->tree.statements.end());
+		this->tree.statements = std::move(old_statements);
+
+		old_spans.erase(first, next);
+		old_spans.insert(old_spans.begin() + first_index, this->statement_spans.begin(), this->statement_spans.end());
+		this->statement_spans = std::move(old_spans);
+
+
+		// the replaced statements would otherwise be left in the tree (with tokens that point into the old source)
+		// 	after a parse error the next reparse starts over anyway
+		if(this->success()){
+			auto token_indices = this->tree.compact();
+
+			for(auto& span : this->statement_spans){
+				span.first_token = token_indices[span.first_token];
+				span.end_token = token_indices[span.end_token];
+			}
+		}
+	};
+
+	std::string_view Parser::get_statement_source(size_t i) const {
+		const auto& span = this->statement_spans[i];
+		return this->stream->get_file().substr(span.start, span.end - span.start);
 	};
 
 
-	Tokenizer::Token Parser::get(){
-		return this->tokens[this->i++];
+	// the reference stays valid until the next call to get()
+	const Tokenizer::Token& Parser::get(){
+		auto& token = this->peek();
+		this->i += 1;
+		this->pull_tokens();
+		return token;
 	};
 
-	Tokenizer::Token Parser::peek(uint offset){
-		return this->tokens[this->i + offset];
+	// offset of -1 (wraps around) is the previous token
+	const Tokenizer::Token& Parser::peek(uint offset){
+		return this->window[(this->i + offset) & window_mask];
+	};
+
+	Tokenizer::Token::Type Parser::peek_kind(uint offset){
+		return this->window[(this->i + offset) & window_mask].type;
+	};
+
+
+	// at least 2 tokens left
+	bool Parser::has_tokens(){
+		return this->peek_kind(1) != TokenType::none;
+	};
+
+
+	// fills the window up to peek(max_lookahead), past the end of the file it's filled with TokenType::none
+	void Parser::pull_tokens(){
+		while(this->lexed <= this->i + max_lookahead){
+			auto& token = this->window[this->lexed & window_mask];
+
+			if(this->tokenizer == nullptr){
+				if(this->lexed < this->tokens->size()){
+					token = this->tokens->get(this->lexed);
+				}else{
+					token = Tokenizer::Token(TokenType::none, this->stream->size());
+				}
+
+			}else if(!this->tokenizer->next(token)){
+				token = Tokenizer::Token(TokenType::none, this->stream->size());
+
+				// the tokenizer already printed the error
+				if(!this->tokenizer->success()){
+					this->has_errored = true;
+				}
+			}
+
+			this->lexed += 1;
+		};
 	};
 
 
 
 	void Parser::error(const Tokenizer::Token& token){
 		this->has_errored = true;
-		cmd::error("\tlocation: <{}, {}>", token.line, token.collumn);
+		auto location = this->stream->get_location(token.end());
+		cmd::error("\tlocation: <{}, {}>", location.line, location.collumn);
+		cmd::error("{}", this->stream->get_snippet(token.position, uint(token.value.size())));
 	};
 
 	void Parser::error(){
@@ -56,7 +217,7 @@ namespace Hawk{
 	};
 
 	bool Parser::expect(Tokenizer::Token::Type expected){
-		if(this->peek().type == expected){
+		if(this->peek_kind() == expected){
 			this->get();
 			return true;
 		}else{
@@ -65,7 +226,7 @@ namespace Hawk{
 		}
 	};
 
-	#define EXPECT(type) if(!this->expect(type)){ return nullptr; };
+	#define EXPECT(type) if(!this->expect(type)){ return {}; };
 
 
 
@@ -99,16 +260,6 @@ namespace Hawk{
 			case TokenType::literal_float:	return "[LITERAL FLOAT]";
 			case TokenType::literal_bool:	return "[LITERAL BOOL]";
 
-			case TokenType::keyword_func:	return "[KEYWORD: func]";
-			case TokenType::keyword_return:	return "[KEYWORD: return]";
-			case TokenType::keyword_if:		return "[KEYWORD: if]";
-			case TokenType::keyword_else:	return "[KEYWORD: else]";
-
-			case TokenType::type_void:		return "[TYPE: void]";
-			case TokenType::type_int:		return "[TYPE: int]";
-			case TokenType::type_float:		return "[TYPE: float]";
-			case TokenType::type_bool:		return "[TYPE: bool]";
-
 			case TokenType::assign:			return "[OPERATOR: '=']";
 			case TokenType::type_def:		return "[OPERATOR: ':']";
 
@@ -133,7 +284,14 @@ namespace Hawk{
 			case TokenType::open_brace:		return "[PUNCTUATION: '{']";
 			case TokenType::close_brace:	return "[PUNCTUATION: '}']";
 
-			default: 						return "[UNKNOWN TOKEN TYPE]";
+			default: {
+				// keywords and types are printed from the same table the Tokenizer recognizes them with
+				const KeywordInfo* keyword = get_keyword_info(token);
+				if(keyword == nullptr){ return "[UNKNOWN TOKEN TYPE]"; }
+
+				const char* kind = keyword->kind == KeywordInfo::Kind::type ? "TYPE" : "KEYWORD";
+				return fmt::format("[{}: {}]", kind, keyword->name);
+			}
 		};
 	};
 
@@ -152,14 +310,14 @@ namespace Hawk{
 	// 		VarDecl      ';'
 	// 		VarAssign	 ';'
 	// 		FuncDef      ';'
-	AST::Stmt* Parser::parse_stmt(){
-		AST::Stmt* output;
+	AST::Stmt Parser::parse_stmt(){
+		AST::Stmt output;
 
-		switch(this->peek().type){
+		switch(this->peek_kind()){
 			case Tokenizer::Token::Type::id: {
-				if(this->peek(1).type == TokenType::open_paren){
+				if(this->peek_kind(1) == TokenType::open_paren){
 					output = this->parse_func_call_stmt();
-				}else if(this->peek(1).type == TokenType::assign){
+				}else if(this->peek_kind(1) == TokenType::assign){
 					output = this->parse_var_assign();
 				}else{
 					output = this->parse_var_decl();
@@ -176,7 +334,7 @@ namespace Hawk{
 			} break;
 			default: {
 				ERROR("Received invalid begin to statement ({})", this->print_token(this->peek()));
-				return nullptr;
+				return {};
 			};
 		};
 
@@ -188,44 +346,118 @@ namespace Hawk{
 
 	// FuncCallStmt
 	// 		FuncCall
-	AST::FuncCallStmt* Parser::parse_func_call_stmt(){
-		return new AST::FuncCallStmt(this->parse_func_call());
+	AST::Index<AST::FuncCallStmt> Parser::parse_func_call_stmt(){
+		return this->tree.add(AST::FuncCallStmt(this->parse_func_call()));
 	};
 
 	// ReturnStmt
 	// 		Expr
-	AST::ReturnStmt* Parser::parse_return_stmt(){
+	AST::Index<AST::ReturnStmt> Parser::parse_return_stmt(){
 		EXPECT(TokenType::keyword_return);
 
 		auto expr = this->parse_expr();
 
-		if(expr == nullptr){
+		if(expr.is_none()){
 			ERROR("Expected expression in return statement, got ({})", this->print_token(this->peek()));
-			return nullptr;
+			return {};
 		}
 
 
-		return new AST::ReturnStmt(expr);
+		return this->tree.add(AST::ReturnStmt(expr));
 	};
 
 
 	// Block
 	// 		'{' '}'
 	// 		'{' Stmt+ '}'
-	AST::Block* Parser::parse_block(){
-		EXPECT(TokenType::open_brace);
+	// 	the conditionals in it (and their blocks) are parsed with an explicit stack of open blocks, so nesting depth can't overflow the call stack
+	// 	nodes are added in the same order as parsing them recursively would
+	AST::Index<AST::Block> Parser::parse_block(){
+		size_t blocks_start = this->open_blocks.size();
+
+		auto open_block = [&](AST::Expr cond, AST::Index<AST::Conditional> last_arm, AST::Stmt first_arm) -> bool {
+			if(!this->expect(TokenType::open_brace)) return false;
+
+			this->open_blocks.push_back(OpenBlock{
+				.start = this->tree.add_token(this->peek(-1)),
+				.scratch_start = this->stmt_scratch.size(),
+				.cond = cond,
+				.last_arm = last_arm,
+				.first_arm = first_arm,
+			});
+			return true;
+		};
 
-		auto* block = new AST::Block(this->peek(-1));
-		while(this->peek().type != TokenType::close_brace){
-			auto stmt = this->parse_stmt();
-			if(stmt == nullptr) return nullptr;
+		// 'if' '(' Expr ')' '{'
+		auto open_arm = [&](AST::Index<AST::Conditional> last_arm, AST::Stmt first_arm) -> bool {
+			auto cond = this->parse_conditional_cond();
+			if(cond.is_none()) return false;
 
-			block->stmts.push_back(stmt);
+			return open_block(cond, last_arm, first_arm);
 		};
 
-		EXPECT(TokenType::close_brace);
+		auto fail = [&]() -> AST::Index<AST::Block> {
+			this->open_blocks.resize(blocks_start);
+			return {};
+		};
+
+
+		if(!open_block({}, {}, {})) return fail();
+
+		while(true){
+			if(this->peek_kind() == TokenType::keyword_if){
+				if(!open_arm({}, {})) return fail();
+				continue;
+			}
+
+			if(this->peek_kind() != TokenType::close_brace){
+				auto stmt = this->parse_stmt();
+				if(stmt.is_none()) return fail();
+
+				this->stmt_scratch.push_back(stmt);
+				continue;
+			}
+
+
+			this->get();
+
+			auto open = this->open_blocks.back();
+			this->open_blocks.pop_back();
+
+			auto block = this->tree.add(AST::Block(this->pop_scratch(this->stmt_scratch, open.scratch_start), open.start));
+			if(this->open_blocks.size() == blocks_start) return block;
+
+
+			// else block, the chain is done
+			AST::Stmt chain = open.first_arm;
+
+			if(open.cond.is_none()){
+				this->tree.get(open.last_arm).else_block = block;
+
+			// then block of an arm, linked in as the else of the arm before it
+			}else{
+				auto arm = this->tree.add(AST::Conditional(open.cond, block, AST::Stmt()));
+				if(open.last_arm.is_none()){
+					chain = arm;
+				}else{
+					this->tree.get(open.last_arm).else_block = arm;
+				}
+
+				if(this->peek_kind() == TokenType::keyword_else){
+					this->get();
 
-		return block;
+					if(this->peek_kind() == TokenType::keyword_if){
+						if(!open_arm(arm, chain)) return fail();
+					}else{
+						if(!open_block({}, arm, chain)) return fail();
+					}
+					continue;
+				}
+			}
+
+			if(!this->expect(TokenType::semicolon)) return fail();
+			this->stmt_scratch.push_back(chain);
+		};
 	};
 
 
@@ -234,11 +466,11 @@ namespace Hawk{
 	// 		Id ':'      '=' Expr
 	// 		Id ':' Type '=' Expr
 	// 		Id ':' Type         
-	AST::VarDecl* Parser::parse_var_decl(){
+	AST::Index<AST::VarDecl> Parser::parse_var_decl(){
 		auto id = this->parse_id();
-		if(id == nullptr){
+		if(id.is_none()){
 			this->uncaught_error();
-			return nullptr;
+			return {};
 		}
 
 
@@ -247,24 +479,24 @@ namespace Hawk{
 
 		auto type = this->parse_type();
 
-		AST::Expr* value = nullptr;
+		AST::Expr value{};
 
 		// option 1
-		if(type == nullptr){
+		if(type.is_none()){
 			EXPECT(TokenType::assign);
 			value = this->parse_expr();
-			if(value == nullptr){
+			if(value.is_none()){
 				ERROR("Expected Expression in Variable Declaration, got ({})", this->print_token(this->peek()));
-				return nullptr;
+				return {};
 			}
 
 		// option 2
-		}else if(this->peek().type == TokenType::assign){
+		}else if(this->peek_kind() == TokenType::assign){
 			EXPECT(TokenType::assign);
 			value = this->parse_expr();
-			if(value == nullptr){
+			if(value.is_none()){
 				ERROR("Expected Expression in Variable Declaration, got ({})", this->print_token(this->peek()));
-				return nullptr;
+				return {};
 			}			
 
 		// option 3
@@ -273,29 +505,29 @@ namespace Hawk{
 		}
 
 
-		return new AST::VarDecl(id, type, value);
+		return this->tree.add(AST::VarDecl(id, type, value));
 
 	};
 
 
 	// VarAssign
 	// 		Id '=' Expr
-	AST::VarAssign* Parser::parse_var_assign(){
+	AST::Index<AST::VarAssign> Parser::parse_var_assign(){
 		auto id = this->parse_id();
-		if(id == nullptr){
+		if(id.is_none()){
 			this->uncaught_error();
-			return nullptr;
+			return {};
 		}
 
 		EXPECT(TokenType::assign);
 
 		auto value = this->parse_expr();
-		if(value == nullptr){
+		if(value.is_none()){
 			ERROR("Expected Expression in Variable Assignment, got ({})", this->print_token(this->peek()));
-			return nullptr;
+			return {};
 		}
 
-		return new AST::VarAssign(id, value);
+		return this->tree.add(AST::VarAssign(id, value));
 
 	};
 
@@ -306,27 +538,26 @@ namespace Hawk{
 	// FuncDef
 	// 		'func' Id Params type Block
 	// 		'func' Id Params      Block
-	AST::FuncDef* Parser::parse_func_def(){
+	AST::Index<AST::FuncDef> Parser::parse_func_def(){
 		EXPECT(TokenType::keyword_func);
 
 		auto id = this->parse_id();
-		if(id == nullptr){
+		if(id.is_none()){
 			ERROR("Expected Id for function definition, got ({})", this->print_token(this->peek()));
-			return nullptr;
+			return {};
 		}
 
 		auto params = this->parse_def_params();
-		if(params == nullptr) return nullptr;
+		if(!this->success()) return {};
 
 
 		auto return_type = this->parse_type();
 
 
 		auto block = this->parse_block();
-		if(params == nullptr) return nullptr;
 
 
-		return new AST::FuncDef(id, return_type, params, block);
+		return this->tree.add(AST::FuncDef(id, return_type, params, block));
 	};
 
 
@@ -334,33 +565,54 @@ namespace Hawk{
 	// 		'if' '(' Expr ')' Block
 	// 		'if' '(' Expr ')' Block 'else' Block
 	// 		'if' '(' Expr ')' Block 'else' Conditional
-	AST::Conditional* Parser::parse_conditional(){
-		EXPECT(TokenType::keyword_if);
+	// 	'else if' chains are parsed in a loop, each arm is linked in as the else of the arm before it
+	// 	(conditionals inside a block are parsed by parse_block())
+	AST::Index<AST::Conditional> Parser::parse_conditional(){
+		AST::Index<AST::Conditional> output{};
+		AST::Index<AST::Conditional> last_arm{};
 
-		EXPECT(TokenType::open_paren);
-			auto cond = this->parse_expr();
-			if(cond == nullptr){
-				ERROR("Expected conditional expression, got ({})", this->print_token(this->peek()));
-				return nullptr;
+		while(true){
+			auto cond = this->parse_conditional_cond();
+			if(cond.is_none()) return {};
+
+			auto then_block = this->parse_block();
+
+			auto arm = this->tree.add(AST::Conditional(cond, then_block, AST::Stmt()));
+			if(last_arm.is_none()){
+				output = arm;
+			}else{
+				this->tree.get(last_arm).else_block = arm;
 			}
-		EXPECT(TokenType::close_paren);
+			last_arm = arm;
 
-		auto then_block = this->parse_block();
 
-		AST::Stmt* else_block = nullptr;
-		if(this->peek().type == TokenType::keyword_else){
+			if(this->peek_kind() != TokenType::keyword_else) break;
 			this->get();
 
-			if(this->peek().type == TokenType::keyword_if){
-				else_block = this->parse_conditional();
-			}else{
-				else_block = this->parse_block();
+			if(this->peek_kind() != TokenType::keyword_if){
+				auto else_block = this->parse_block();
+				this->tree.get(last_arm).else_block = else_block;
+				break;
 			}
-		}
+		};
 
+		return output;
+	};
+
+
+	// 'if' '(' Expr ')'
+	AST::Expr Parser::parse_conditional_cond(){
+		EXPECT(TokenType::keyword_if);
 
-		return new AST::Conditional(cond, then_block, else_block);
+		EXPECT(TokenType::open_paren);
+			auto cond = this->parse_expr();
+			if(cond.is_none()){
+				ERROR("Expected conditional expression, got ({})", this->print_token(this->peek()));
+				return {};
+			}
+		EXPECT(TokenType::close_paren);
 
+		return cond;
 	};
 
 
@@ -373,60 +625,75 @@ namespace Hawk{
 
 	// FuncCall
 	// 		Id Params
-	AST::FuncCall* Parser::parse_func_call(){
+	AST::Index<AST::FuncCall> Parser::parse_func_call(){
 		auto id = this->parse_id();
 		auto params = this->parse_params();
 
-		return new AST::FuncCall(id, params);
+		return this->tree.add(AST::FuncCall(id, params));
 	};
 
 
 
-	AST::Expr* Parser::parse_expr(){
+	AST::Expr Parser::parse_expr(){
 		auto term = this->parse_term();
-		if(term == nullptr) return nullptr;
+		if(term.is_none()) return {};
 		
 		return this->parse_op(term, 0);
 	};
 
 
-	AST::Expr* Parser::parse_op(AST::Expr* left, uint prec){
-		switch(this->peek().type){
-			case TokenType::op_plus:
-			case TokenType::op_minus:
-			case TokenType::op_mult:
-			case TokenType::op_div:
+	// precedence climbing without recursion
+	// 	operands and operators wait on the scratch stacks until an operator that binds looser (or the end) is found,
+	// 	so precedence only goes up from the bottom of the stack to the top
+	// 	operators of the same precedence are reduced left to right
+	AST::Expr Parser::parse_op(AST::Expr left, uint prec){
+		size_t operands_start = this->expr_scratch.size();
+		size_t ops_start = this->op_scratch.size();
 
-			case TokenType::op_lt:
-			case TokenType::op_lte:
-			case TokenType::op_gt:
-			case TokenType::op_gte:
-			case TokenType::op_eq:
-			case TokenType::op_neq:
-			
-			case TokenType::op_and:
-			case TokenType::op_or:
-		{
-				auto next_op_prec = this->get_op_prec(this->peek());
+		this->expr_scratch.push_back(left);
 
-				if(next_op_prec > prec){
-					auto next_op = this->get();
+		auto reduce = [&](){
+			auto right = this->expr_scratch.back();
+			this->expr_scratch.pop_back();
 
-					return this->parse_op(new AST::Binary(
-						left,
-						next_op, 
-						this->parse_op(this->parse_term(), next_op_prec)
-					), prec);
-				}
+			auto& operand = this->expr_scratch.back();
+			operand = this->tree.add(AST::Binary(operand, right, this->op_scratch.back()));
+			this->op_scratch.pop_back();
+		};
 
-			} break;
+
+		while(this->is_operator(this->peek_kind())){
+			auto next_op_prec = this->get_op_prec(this->peek_kind());
+			if(next_op_prec <= prec) break;
+
+			while(this->op_scratch.size() > ops_start && this->get_op_prec(this->tree.tokens.kind(this->op_scratch.back())) >= next_op_prec){
+				reduce();
+			}
+
+			this->op_scratch.push_back(this->tree.add_token(this->get()));
+
+			auto right_term = this->parse_term();
+			if(right_term.is_none()){
+				ERROR("Expected expression after operator, got ({})", this->print_token(this->peek()));
+				this->expr_scratch.resize(operands_start);
+				this->op_scratch.resize(ops_start);
+				return {};
+			}
+
+			this->expr_scratch.push_back(right_term);
 		};
 
-		return left;
+		while(this->op_scratch.size() > ops_start){
+			reduce();
+		}
+
+		auto output = this->expr_scratch.back();
+		this->expr_scratch.resize(operands_start);
+		return output;
 	};
 
-	uint Parser::get_op_prec(const Tokenizer::Token& op){
-		switch(op.type){
+	uint Parser::get_op_prec(Tokenizer::Token::Type op){
+		switch(op){
 			case TokenType::op_and:		return 1;
 			case TokenType::op_or:		return 1;
 
@@ -455,24 +722,24 @@ namespace Hawk{
 	// 		Literal
 	// 		Id
 	// 		FuncCall
-	AST::Expr* Parser::parse_term(){
-		AST::Expr* output = nullptr;
+	AST::Expr Parser::parse_term(){
+		AST::Expr output{};
 
 		output = this->parse_literal();
-		if(output != nullptr) return output;
+		if(!output.is_none()) return output;
 
 
-		if(this->peek().type == TokenType::id){
-			if(this->peek(1).type == TokenType::open_paren ){
+		if(this->peek_kind() == TokenType::id){
+			if(this->peek_kind(1) == TokenType::open_paren ){
 				output = this->parse_func_call();
 			}else{
 				output = this->parse_id();
 			}
-			if(output != nullptr) return output;
+			if(!output.is_none()) return output;
 		}
 
 
-		return nullptr;
+		return {};
 	};
 
 
@@ -481,14 +748,15 @@ namespace Hawk{
 	// Type
 	// 		'type_keyword'
 	// 		Id
-	AST::Type* Parser::parse_type(){
-		switch(this->peek().type){
-			case TokenType::id: 		return dynamic_cast<AST::Type*>(this->parse_id());
-			case TokenType::type_int:	return new AST::Type(this->get());
-			case TokenType::type_float:	return new AST::Type(this->get());
-			case TokenType::type_void:	return new AST::Type(this->get());
-			case TokenType::type_bool:	return new AST::Type(this->get());
-			default: 					return nullptr;
+	AST::Index<AST::Type> Parser::parse_type(){
+		switch(this->peek_kind()){
+			// user defined types aren't supported yet, the id is consumed but no type is made
+			case TokenType::id: 		this->get(); return {};
+			case TokenType::type_int:	return this->tree.add(AST::Type(this->tree.add_token(this->get())));
+			case TokenType::type_float:	return this->tree.add(AST::Type(this->tree.add_token(this->get())));
+			case TokenType::type_void:	return this->tree.add(AST::Type(this->tree.add_token(this->get())));
+			case TokenType::type_bool:	return this->tree.add(AST::Type(this->tree.add_token(this->get())));
+			default: 					return {};
 		};
 	};
 
@@ -497,25 +765,27 @@ namespace Hawk{
 	// 		'(' ')'
 	// 		'(' Param ')'
 	// 		'(' (Param ',')+ Param ')'
-	AST::Params* Parser::parse_params(){
+	AST::List<AST::Expr> Parser::parse_params(){
 		EXPECT(TokenType::open_paren);
 
-		auto params = new AST::Params(this->peek(-1));
+		size_t scratch_start = this->expr_scratch.size();
 
-		while(this->peek().type != TokenType::close_paren){
-			if(params->params.size() > 0){
+		while(this->peek_kind() != TokenType::close_paren){
+			if(this->expr_scratch.size() > scratch_start){
 				EXPECT(TokenType::comma);
 			}
 
 			auto param = this->parse_param();
-			if(param == nullptr){
+			if(param.is_none()){
 				ERROR("Expected Expression in parameter list, got ({})");
-				return nullptr;
+				return {};
 			}
 
-			params->params.push_back(param);
+			this->expr_scratch.push_back(param);
 		};
 
+		auto params = this->pop_scratch(this->expr_scratch, scratch_start);
+
 		EXPECT(TokenType::close_paren);
 
 		return params;
@@ -524,13 +794,8 @@ namespace Hawk{
 
 	// Param
 	// 		Expr
-	AST::Param* Parser::parse_param(){
-		auto expr = this->parse_expr();
-		if(expr != nullptr){
-			return static_cast<AST::Param*>(expr);
-		}else{
-			return nullptr;
-		}
+	AST::Expr Parser::parse_param(){
+		return this->parse_expr();
 	};
 
 
@@ -539,23 +804,27 @@ namespace Hawk{
 	// 		'(' ')'
 	// 		'(' DefParam ')'
 	// 		'(' (DefParam ',')+ DefParam ')'
-	AST::DefParams* Parser::parse_def_params(){
+	AST::List<AST::VarDecl> Parser::parse_def_params(){
 		EXPECT(TokenType::open_paren);
 
-		auto params = new AST::DefParams(this->peek(-1));
+		// the params are the only VarDecls made until the ')', so they end up next to each other in the tree
+		auto params = AST::List<AST::VarDecl>();
 
-		while(this->peek().type != TokenType::close_paren){
-			if(params->params.size() > 0){
+		while(this->peek_kind() != TokenType::close_paren){
+			if(params.size > 0){
 				EXPECT(TokenType::comma);
 			}
 
-			auto* param = this->parse_def_param();
-			if(param == nullptr){
+			auto param = this->parse_def_param();
+			if(param.is_none()){
 				ERROR("Expected parameter definition in parameter list, got ({})");
-				return nullptr;
+				return {};
 			}
 
-			params->params.push_back(param);
+			if(params.size == 0){
+				params.start = param.value;
+			}
+			params.size += 1;
 		};
 
 		EXPECT(TokenType::close_paren);
@@ -566,16 +835,16 @@ namespace Hawk{
 
 	// DefParam
 	// 		Id ':' Type
-	AST::DefParam* Parser::parse_def_param(){
+	AST::Index<AST::VarDecl> Parser::parse_def_param(){
 		auto id = this->parse_id();
-		if(id == nullptr) return nullptr;
+		if(id.is_none()) return {};
 
 		EXPECT(TokenType::type_def);
 
 		auto type = this->parse_type();
-		if(type == nullptr) return nullptr;
+		if(type.is_none()) return {};
 
-		return new AST::DefParam(id, type);
+		return this->tree.add(AST::VarDecl(id, type, AST::Expr()));
 	};
 
 
@@ -583,20 +852,48 @@ namespace Hawk{
 	// 		literal_int
 	// 		literal_float
 	// 		literal_bool
-	AST::Literal* Parser::parse_literal(){
-		switch(this->peek().type){
-			case TokenType::literal_int:	return new AST::Literal(this->get());
-			case TokenType::literal_float:	return new AST::Literal(this->get());
-			case TokenType::literal_bool:	return new AST::Literal(this->get());
-			default: 						return nullptr;
+	AST::Index<AST::Literal> Parser::parse_literal(){
+		switch(this->peek_kind()){
+			case TokenType::literal_int:	return this->tree.add(AST::Literal(this->tree.add_token(this->get())));
+			case TokenType::literal_float:	return this->tree.add(AST::Literal(this->tree.add_token(this->get())));
+			case TokenType::literal_bool:	return this->tree.add(AST::Literal(this->tree.add_token(this->get())));
+			default: 						return {};
 		};
 	};
 
 
-	AST::Id* Parser::parse_id(){
-		if(this->peek().type != TokenType::id) return nullptr;
+	AST::Index<AST::Id> Parser::parse_id(){
+		if(this->peek_kind() != TokenType::id) return {};
+
+		return this->tree.add(AST::Id(this->tree.add_token(this->get())));
+	};
+
+
+
+	//////////////////////////////////////////////////////////////////////
+	// is
+
+	bool Parser::is_operator(Tokenizer::Token::Type token_type){
+		switch(token_type){
+			case TokenType::op_plus:
+			case TokenType::op_minus:
+			case TokenType::op_mult:
+			case TokenType::op_div:
+
+			case TokenType::op_lt:
+			case TokenType::op_lte:
+			case TokenType::op_gt:
+			case TokenType::op_gte:
+			case TokenType::op_eq:
+			case TokenType::op_neq:
+			
+			case TokenType::op_and:
+			case TokenType::op_or:
+				return true;
 
-		return new AST::Id(this->get());
+			default:
+				return false;
+		};
 	};
 
 
@@ -615,159 +912,610 @@ namespace Hawk{
 
 
 
-	void AST::Id::print(uint ident){
-		cmd::log("{}Id: {}", indentation(ident), this->token.value);
+	void AST::Tree::print(Index<Id> id, uint ident) const {
+		cmd::log("{}Id: {}", indentation(ident), this->get_token(id).value);
 	};
 
-	void AST::Type::print(uint ident){
-		cmd::log("{}Type: {}", indentation(ident), this->token.value);
+	void AST::Tree::print(Index<Type> type, uint ident) const {
+		if(type.is_none()){
+			cmd::log("{}Type: auto", indentation(ident));
+		}else{
+			cmd::log("{}Type: {}", indentation(ident), this->get_token(type).value);
+		}
 	};
 
-	void AST::Keyword::print(uint ident){
-		cmd::log("{}Keyword: {}", indentation(ident), this->token.value);
-	};
 
-	void AST::Literal::print(uint ident){
-		cmd::log("{}Literal: {}", indentation(ident), this->token.value);
-	};
-
-	void AST::Params::print(uint ident){
-		if(this->params.size() > 0){
+	void AST::Tree::print(List<Expr> params, uint ident) const {
+		if(params.size > 0){
 			cmd::log("{}Params:", indentation(ident));
-
-			for(auto* param : this->params){
-				param->print(ident + 1);
+			for(auto param : this->get(params)){
+				this->print(param, ident + 1);
 			}
 		}else{
 			cmd::log("{}Params: (empty)", indentation(ident));
 		}
 	};
 
-	void AST::Param::print(uint ident){
-		cmd::log("{}Param:", indentation(ident));
-		this->expr->print(ident + 1);
-	};
 
+	void AST::Tree::print(Expr expr, uint ident) const {
+		switch(expr.get_type()){
+			case ExprType::Id: {
+				this->print(Index<Id>(expr.index()), ident);
 
-	void AST::DefParams::print(uint ident){
-		if(this->params.size() > 0){
-			cmd::log("{}DefParams:", indentation(ident));
+			} break; case ExprType::Literal: {
+				cmd::log("{}Literal: {}", indentation(ident), this->get_token(expr).value);
 
-			for(auto* param : this->params){
-				param->print(ident + 1);
-			}
-		}else{
-			cmd::log("{}DefParams: (empty)", indentation(ident));
-		}
+			} break; case ExprType::FuncCall: {
+				const auto& func_call = this->get<FuncCall>(expr);
+				cmd::log("{}FuncCall:", indentation(ident));
+				this->print(func_call.id, ident + 1);
+				this->print(func_call.params, ident + 1);
+
+			} break; case ExprType::Binary: {
+				const auto& binary = this->get<Binary>(expr);
+				cmd::log("{}Binary:", indentation(ident));
+				cmd::log("{}op: {}", indentation(ident + 1), this->get_token(binary.op).value);
+				this->print(binary.left, ident + 1);
+				this->print(binary.right, ident + 1);
+			} break;
+		};
 	};
 
 
-	void AST::DefParam::print(uint ident){
-		cmd::log("{}DefParam:", indentation(ident));
-		this->id->print(ident + 1);
-		this->type->print(ident + 1);
+	void AST::Tree::print(Stmt stmt, uint ident) const {
+		switch(stmt.get_type()){
+			case StmtType::Block: {
+				const auto& block = this->get<Block>(stmt);
+
+				if(block.stmts.size > 0){
+					cmd::log("{}Block:", indentation(ident));
+
+					for(auto block_stmt : this->get(block.stmts)){
+						this->print(block_stmt, ident + 1);
+					}
+				}else{
+					cmd::log("{}Block: (empty)", indentation(ident));
+				}
+
+			} break; case StmtType::VarDecl: {
+				const auto& var_decl = this->get<VarDecl>(stmt);
+				cmd::log("{}VarDecl:", indentation(ident));
+				this->print(var_decl.id, ident + 1);
+				this->print(var_decl.type, ident + 1);
+
+				if(!var_decl.value.is_none()){
+					this->print(var_decl.value, ident + 1);
+				}else{
+					cmd::log("{}Value: uninitialized", indentation(ident + 1));
+				}
+
+			} break; case StmtType::VarAssign: {
+				const auto& var_assign = this->get<VarAssign>(stmt);
+				cmd::log("{}VarAssign:", indentation(ident));
+				this->print(var_assign.id, ident + 1);
+				this->print(var_assign.value, ident + 1);
+
+			} break; case StmtType::FuncDef: {
+				const auto& func_def = this->get<FuncDef>(stmt);
+				cmd::log("{}FuncDef:", indentation(ident));
+				this->print(func_def.id, ident + 1);
+				this->print(func_def.return_type, ident + 1);
+
+				if(func_def.params.size > 0){
+					cmd::log("{}DefParams:", indentation(ident + 1));
+					for(const auto& param : this->get(func_def.params)){
+						cmd::log("{}DefParam:", indentation(ident + 2));
+						this->print(param.id, ident + 3);
+						this->print(param.type, ident + 3);
+					}
+				}else{
+					cmd::log("{}DefParams: (empty)", indentation(ident + 1));
+				}
+
+				this->print(Stmt(func_def.block), ident + 1);
+
+			} break; case StmtType::FuncCallStmt: {
+				// the FuncCall itself isn't printed, only its id and params
+				const auto& func_call = this->get(this->get<FuncCallStmt>(stmt).expr);
+				cmd::log("{}FuncCallStmt:", indentation(ident));
+				this->print(func_call.id, ident + 1);
+				this->print(func_call.params, ident + 1);
+
+			} break; case StmtType::ReturnStmt: {
+				cmd::log("{}ReturnStmt:", indentation(ident));
+				this->print(this->get<ReturnStmt>(stmt).expr, ident + 1);
+
+			} break; case StmtType::Conditional: {
+				const auto& conditional = this->get<Conditional>(stmt);
+				cmd::log("{}Conditional:", indentation(ident));
+				this->print(conditional.cond, ident + 1);
+				this->print(Stmt(conditional.then_block), ident + 1);
+
+				if(!conditional.else_block.is_none()){
+					this->print(conditional.else_block, ident + 1);
+				}
+			} break;
+		};
 	};
 
 
 
+	//////////////////////////////////////////////////////////////////////
+	// serialization
+
+	void AST::Tree::write(std::string& output) const {
+		std::apply([&](const auto&... arrays){
+			(files::write_array(output, std::span(arrays)), ...);
+		}, this->arrays);
 
-	void AST::FuncCall::print(uint ident){
-		cmd::log("{}FuncCall:", indentation(ident));
-		this->id->print(ident + 1);
-		this->params->print(ident + 1);
+		files::write_array<Stmt>(output, this->statements);
+		this->tokens.write(output);
 	};
 
-	void AST::Binary::print(uint ident){
-		cmd::log("{}Binary:", indentation(ident));
-		cmd::log("{}op: {}", indentation(ident + 1), this->op.value);
-		this->left->print(ident + 1);
-		this->right->print(ident + 1);
+	bool AST::Tree::read(std::string_view& input, symbols::Interner& interner){
+		bool success = std::apply([&](auto&... arrays){
+			return (files::read_array(input, arrays) && ...);
+		}, this->arrays);
+
+		return success
+			&& files::read_array(input, this->statements)
+			&& this->tokens.read(input, interner);
 	};
 
 
 
+	//////////////////////////////////////////////////////////////////////
+	// merging
+
+	void AST::Tree::append(const Tree& other, std::span<const SymbolId> symbol_map){
+		// where the nodes of `other` start once they're added
+		const auto ids             = uint32_t(this->array<Id>().size());
+		const auto types           = uint32_t(this->array<Type>().size());
+		const auto literals        = uint32_t(this->array<Literal>().size());
+		const auto func_calls      = uint32_t(this->array<FuncCall>().size());
+		const auto binaries        = uint32_t(this->array<Binary>().size());
+		const auto blocks          = uint32_t(this->array<Block>().size());
+		const auto var_decls       = uint32_t(this->array<VarDecl>().size());
+		const auto var_assigns     = uint32_t(this->array<VarAssign>().size());
+		const auto func_call_stmts = uint32_t(this->array<FuncCallStmt>().size());
+		const auto return_stmts    = uint32_t(this->array<ReturnStmt>().size());
+		const auto func_defs       = uint32_t(this->array<FuncDef>().size());
+		const auto conditionals    = uint32_t(this->array<Conditional>().size());
+		const auto expr_lists      = uint32_t(this->array<Expr>().size());
+		const auto stmt_lists      = uint32_t(this->array<Stmt>().size());
+		const auto token_offset    = TokenIndex(this->tokens.size());
+
+
+		auto move_index = []<typename Node>(Index<Node> index, uint32_t offset){
+			if(!index.is_none()){ index.value += offset; }
+			return index;
+		};
 
+		auto move_expr = [&](Expr expr){
+			if(expr.is_none()){ return expr; }
 
+			switch(expr.get_type()){
+				case ExprType::Id:       return Expr(ExprType::Id, expr.index() + ids);
+				case ExprType::Literal:  return Expr(ExprType::Literal, expr.index() + literals);
+				case ExprType::FuncCall: return Expr(ExprType::FuncCall, expr.index() + func_calls);
+				default:                 return Expr(ExprType::Binary, expr.index() + binaries);
+			};
+		};
 
+		auto move_stmt = [&](Stmt stmt){
+			if(stmt.is_none()){ return stmt; }
+
+			switch(stmt.get_type()){
+				case StmtType::Block:        return Stmt(StmtType::Block, stmt.index() + blocks);
+				case StmtType::VarDecl:      return Stmt(StmtType::VarDecl, stmt.index() + var_decls);
+				case StmtType::VarAssign:    return Stmt(StmtType::VarAssign, stmt.index() + var_assigns);
+				case StmtType::FuncCallStmt: return Stmt(StmtType::FuncCallStmt, stmt.index() + func_call_stmts);
+				case StmtType::ReturnStmt:   return Stmt(StmtType::ReturnStmt, stmt.index() + return_stmts);
+				case StmtType::FuncDef:      return Stmt(StmtType::FuncDef, stmt.index() + func_defs);
+				default:                     return Stmt(StmtType::Conditional, stmt.index() + conditionals);
+			};
+		};
 
 
-	void AST::Block::print(uint ident){
-		if(this->stmts.size() > 0){
-			cmd::log("{}Block:", indentation(ident));
+		for(auto id : other.array<Id>()){
+			id.token += token_offset;
+			this->add(id);
+		}
 
-			for(auto* stmt : this->stmts){
-				stmt->print(ident + 1);
-			}
-		}else{
-			cmd::log("{}Block: (empty)", indentation(ident));
+		for(auto type : other.array<Type>()){
+			type.token += token_offset;
+			this->add(type);
 		}
-	};
 
+		for(auto literal : other.array<Literal>()){
+			literal.token += token_offset;
+			this->add(literal);
+		}
 
+		for(auto func_call : other.array<FuncCall>()){
+			func_call.id = move_index(func_call.id, ids);
+			func_call.params.start += expr_lists;
+			this->add(func_call);
+		}
 
-	void AST::VarDecl::print(uint ident){
-		cmd::log("{}VarDecl:", indentation(ident));
-		this->id->print(ident + 1);
+		for(auto binary : other.array<Binary>()){
+			binary.left = move_expr(binary.left);
+			binary.right = move_expr(binary.right);
+			binary.op += token_offset;
+			this->add(binary);
+		}
 
-		if(this->type != nullptr){
-			this->type->print(ident + 1);
-		}else{
-			cmd::log("{}Type: auto", indentation(ident + 1));
+		for(auto block : other.array<Block>()){
+			block.stmts.start += stmt_lists;
+			block.start += token_offset;
+			this->add(block);
 		}
 
-		if(this->value != nullptr){
-			this->value->print(ident + 1);
-		}else{
-			cmd::log("{}Value: uninitialized", indentation(ident + 1));
+		for(auto var_decl : other.array<VarDecl>()){
+			var_decl.id = move_index(var_decl.id, ids);
+			var_decl.type = move_index(var_decl.type, types);
+			var_decl.value = move_expr(var_decl.value);
+			this->add(var_decl);
 		}
-	};
 
-	void AST::VarAssign::print(uint ident){
-		cmd::log("{}VarAssign:", indentation(ident));
-		this->id->print(ident + 1);
-		this->value->print(ident + 1);
-	};
+		for(auto var_assign : other.array<VarAssign>()){
+			var_assign.id = move_index(var_assign.id, ids);
+			var_assign.value = move_expr(var_assign.value);
+			this->add(var_assign);
+		}
 
+		for(auto func_call_stmt : other.array<FuncCallStmt>()){
+			func_call_stmt.expr = move_index(func_call_stmt.expr, func_calls);
+			this->add(func_call_stmt);
+		}
 
-	void AST::FuncDef::print(uint ident){
-		cmd::log("{}FuncDef:", indentation(ident));
-		this->id->print(ident + 1);
+		for(auto return_stmt : other.array<ReturnStmt>()){
+			return_stmt.expr = move_expr(return_stmt.expr);
+			this->add(return_stmt);
+		}
 
-		if(this->return_type != nullptr){
-			this->return_type->print(ident + 1);
-		}else{
-			cmd::log("{}Type: auto", indentation(ident + 1));
+		for(auto func_def : other.array<FuncDef>()){
+			func_def.id = move_index(func_def.id, ids);
+			func_def.return_type = move_index(func_def.return_type, types);
+			func_def.params.start += var_decls;
+			func_def.block = move_index(func_def.block, blocks);
+			this->add(func_def);
 		}
 
-		this->params->print(ident + 1);
-		this->block->print(ident + 1);
+		for(auto conditional : other.array<Conditional>()){
+			conditional.cond = move_expr(conditional.cond);
+			conditional.then_block = move_index(conditional.then_block, blocks);
+			conditional.else_block = move_stmt(conditional.else_block);
+			this->add(conditional);
+		}
 
-	};
+		for(auto expr : other.array<Expr>()){
+			this->array<Expr>().emplace_back(move_expr(expr));
+		}
 
+		for(auto stmt : other.array<Stmt>()){
+			this->array<Stmt>().emplace_back(move_stmt(stmt));
+		}
 
-	void AST::FuncCallStmt::print(uint ident){
-		cmd::log("{}FuncCallStmt:", indentation(ident));
-		this->expr->id->print(ident + 1);
-		this->expr->params->print(ident + 1);
+		for(auto stmt : other.statements){
+			this->statements.emplace_back(move_stmt(stmt));
+		}
+
+		this->tokens.append(other.tokens, symbol_map);
 	};
 
-	void AST::ReturnStmt::print(uint ident){
-		cmd::log("{}ReturnStmt:", indentation(ident));
-		this->expr->print(ident + 1);
+
+
+	//////////////////////////////////////////////////////////////////////
+	// compacting
+
+	// the items of `array` where `new_indices` (see Tree::compact()) steps are moved down to their new index
+	template<typename T, typename Move>
+	static void keep_marked(std::vector<T>& array, const std::vector<uint32_t>& new_indices, const Move& move){
+		for(size_t i = 0; i < array.size(); i++){
+			if(new_indices[i + 1] == new_indices[i]){ continue; }
+			array[new_indices[i]] = move(array[i]);
+		}
+
+		array.resize(new_indices[array.size()]);
 	};
 
-	void AST::Conditional::print(uint ident){
-		cmd::log("{}Conditional:", indentation(ident));
-		this->cond->print(ident + 1);
-		this->then_block->print(ident + 1);
 
-		if(this->else_block != nullptr){
-			this->else_block->print(ident + 1);
+	auto AST::Tree::compact() -> std::vector<TokenIndex> {
+		// one per item of every array (and one for the end), 1 if something references it
+		// 	then summed into the new index of each item
+		auto marks = [](size_t size){ return std::vector<uint32_t>(size + 1, 0); };
+
+		auto ids             = marks(this->array<Id>().size());
+		auto types           = marks(this->array<Type>().size());
+		auto literals        = marks(this->array<Literal>().size());
+		auto func_calls      = marks(this->array<FuncCall>().size());
+		auto binaries        = marks(this->array<Binary>().size());
+		auto blocks          = marks(this->array<Block>().size());
+		auto var_decls       = marks(this->array<VarDecl>().size());
+		auto var_assigns     = marks(this->array<VarAssign>().size());
+		auto func_call_stmts = marks(this->array<FuncCallStmt>().size());
+		auto return_stmts    = marks(this->array<ReturnStmt>().size());
+		auto func_defs       = marks(this->array<FuncDef>().size());
+		auto conditionals    = marks(this->array<Conditional>().size());
+		auto expr_lists      = marks(this->array<Expr>().size());
+		auto stmt_lists      = marks(this->array<Stmt>().size());
+		auto token_indices   = marks(this->tokens.size());
+
+
+		// everything the statements reach, with explicit stacks (expressions and else-if chains can be very deep)
+		auto exprs = std::vector<Expr>();
+		auto stmts = std::vector<Stmt>(this->statements.rbegin(), this->statements.rend());
+
+		auto mark_id = [&](Index<Id> id){
+			if(id.is_none()){ return; }
+			ids[id.value] = 1;
+			token_indices[this->get(id).token] = 1;
+		};
+
+		auto mark_type = [&](Index<Type> type){
+			if(type.is_none()){ return; }
+			types[type.value] = 1;
+			token_indices[this->get(type).token] = 1;
+		};
+
+		auto mark_func_call = [&](Index<FuncCall> index){
+			const auto& func_call = this->get(index);
+			func_calls[index.value] = 1;
+			mark_id(func_call.id);
+
+			std::fill_n(expr_lists.begin() + func_call.params.start, func_call.params.size, 1);
+			for(auto param : this->get(func_call.params)){
+				exprs.push_back(param);
+			}
+		};
+
+		auto mark_var_decl = [&](Index<VarDecl> index){
+			const auto& var_decl = this->get(index);
+			var_decls[index.value] = 1;
+			mark_id(var_decl.id);
+			mark_type(var_decl.type);
+			exprs.push_back(var_decl.value);
+		};
+
+
+		while(!stmts.empty() || !exprs.empty()){
+			if(!exprs.empty()){
+				auto expr = exprs.back();
+				exprs.pop_back();
+				if(expr.is_none()){ continue; }
+
+				switch(expr.get_type()){
+					case ExprType::Id: {
+						mark_id(Index<Id>(expr.index()));
+
+					} break; case ExprType::Literal: {
+						literals[expr.index()] = 1;
+						token_indices[this->get<Literal>(expr).token] = 1;
+
+					} break; case ExprType::FuncCall: {
+						mark_func_call(Index<FuncCall>(expr.index()));
+
+					} break; case ExprType::Binary: {
+						const auto& binary = this->get<Binary>(expr);
+						binaries[expr.index()] = 1;
+						token_indices[binary.op] = 1;
+						exprs.push_back(binary.right);
+						exprs.push_back(binary.left);
+					} break;
+				};
+
+				continue;
+			}
+
+
+			auto stmt = stmts.back();
+			stmts.pop_back();
+			if(stmt.is_none()){ continue; }
+
+			switch(stmt.get_type()){
+				case StmtType::Block: {
+					const auto& block = this->get<Block>(stmt);
+					blocks[stmt.index()] = 1;
+					token_indices[block.start] = 1;
+
+					std::fill_n(stmt_lists.begin() + block.stmts.start, block.stmts.size, 1);
+					for(auto child : this->get(block.stmts)){
+						stmts.push_back(child);
+					}
+
+				} break; case StmtType::VarDecl: {
+					mark_var_decl(Index<VarDecl>(stmt.index()));
+
+				} break; case StmtType::VarAssign: {
+					const auto& var_assign = this->get<VarAssign>(stmt);
+					var_assigns[stmt.index()] = 1;
+					mark_id(var_assign.id);
+					exprs.push_back(var_assign.value);
+
+				} break; case StmtType::FuncCallStmt: {
+					func_call_stmts[stmt.index()] = 1;
+					mark_func_call(this->get<FuncCallStmt>(stmt).expr);
+
+				} break; case StmtType::ReturnStmt: {
+					return_stmts[stmt.index()] = 1;
+					exprs.push_back(this->get<ReturnStmt>(stmt).expr);
+
+				} break; case StmtType::FuncDef: {
+					const auto& func_def = this->get<FuncDef>(stmt);
+					func_defs[stmt.index()] = 1;
+					mark_id(func_def.id);
+					mark_type(func_def.return_type);
+
+					for(uint32_t i = 0; i < func_def.params.size; i++){
+						mark_var_decl(func_def.params.index(i));
+					}
+
+					stmts.push_back(Stmt(func_def.block));
+
+				} break; case StmtType::Conditional: {
+					const auto& conditional = this->get<Conditional>(stmt);
+					conditionals[stmt.index()] = 1;
+					exprs.push_back(conditional.cond);
+					stmts.push_back(conditional.else_block);
+					stmts.push_back(Stmt(conditional.then_block));
+				} break;
+			};
+		};
+
+
+		for(auto* indices : {
+			&ids, &types, &literals, &func_calls, &binaries, &blocks, &var_decls, &var_assigns,
+			&func_call_stmts, &return_stmts, &func_defs, &conditionals, &expr_lists, &stmt_lists, &token_indices,
+		}){
+			std::exclusive_scan(indices->begin(), indices->end(), indices->begin(), uint32_t(0));
 		}
+
+
+		// same as in append(), but every index is looked up instead of moved by an offset
+		auto move_index = []<typename Node>(Index<Node> index, const std::vector<uint32_t>& new_indices){
+			if(!index.is_none()){ index.value = new_indices[index.value]; }
+			return index;
+		};
+
+		auto move_expr = [&](Expr expr){
+			if(expr.is_none()){ return expr; }
+
+			switch(expr.get_type()){
+				case ExprType::Id:       return Expr(ExprType::Id, ids[expr.index()]);
+				case ExprType::Literal:  return Expr(ExprType::Literal, literals[expr.index()]);
+				case ExprType::FuncCall: return Expr(ExprType::FuncCall, func_calls[expr.index()]);
+				default:                 return Expr(ExprType::Binary, binaries[expr.index()]);
+			};
+		};
+
+		auto move_stmt = [&](Stmt stmt){
+			if(stmt.is_none()){ return stmt; }
+
+			switch(stmt.get_type()){
+				case StmtType::Block:        return Stmt(StmtType::Block, blocks[stmt.index()]);
+				case StmtType::VarDecl:      return Stmt(StmtType::VarDecl, var_decls[stmt.index()]);
+				case StmtType::VarAssign:    return Stmt(StmtType::VarAssign, var_assigns[stmt.index()]);
+				case StmtType::FuncCallStmt: return Stmt(StmtType::FuncCallStmt, func_call_stmts[stmt.index()]);
+				case StmtType::ReturnStmt:   return Stmt(StmtType::ReturnStmt, return_stmts[stmt.index()]);
+				case StmtType::FuncDef:      return Stmt(StmtType::FuncDef, func_defs[stmt.index()]);
+				default:                     return Stmt(StmtType::Conditional, conditionals[stmt.index()]);
+			};
+		};
+
+
+		keep_marked(this->array<Id>(), ids, [&](Id id){
+			id.token = token_indices[id.token];
+			return id;
+		});
+
+		keep_marked(this->array<Type>(), types, [&](Type type){
+			type.token = token_indices[type.token];
+			return type;
+		});
+
+		keep_marked(this->array<Literal>(), literals, [&](Literal literal){
+			literal.token = token_indices[literal.token];
+			return literal;
+		});
+
+		keep_marked(this->array<FuncCall>(), func_calls, [&](FuncCall func_call){
+			func_call.id = move_index(func_call.id, ids);
+			func_call.params.start = expr_lists[func_call.params.start];
+			return func_call;
+		});
+
+		keep_marked(this->array<Binary>(), binaries, [&](Binary binary){
+			binary.left = move_expr(binary.left);
+			binary.right = move_expr(binary.right);
+			binary.op = token_indices[binary.op];
+			return binary;
+		});
+
+		keep_marked(this->array<Block>(), blocks, [&](Block block){
+			block.stmts.start = stmt_lists[block.stmts.start];
+			block.start = token_indices[block.start];
+			return block;
+		});
+
+		keep_marked(this->array<VarDecl>(), var_decls, [&](VarDecl var_decl){
+			var_decl.id = move_index(var_decl.id, ids);
+			var_decl.type = move_index(var_decl.type, types);
+			var_decl.value = move_expr(var_decl.value);
+			return var_decl;
+		});
+
+		keep_marked(this->array<VarAssign>(), var_assigns, [&](VarAssign var_assign){
+			var_assign.id = move_index(var_assign.id, ids);
+			var_assign.value = move_expr(var_assign.value);
+			return var_assign;
+		});
+
+		keep_marked(this->array<FuncCallStmt>(), func_call_stmts, [&](FuncCallStmt func_call_stmt){
+			func_call_stmt.expr = move_index(func_call_stmt.expr, func_calls);
+			return func_call_stmt;
+		});
+
+		keep_marked(this->array<ReturnStmt>(), return_stmts, [&](ReturnStmt return_stmt){
+			return_stmt.expr = move_expr(return_stmt.expr);
+			return return_stmt;
+		});
+
+		keep_marked(this->array<FuncDef>(), func_defs, [&](FuncDef func_def){
+			func_def.id = move_index(func_def.id, ids);
+			func_def.return_type = move_index(func_def.return_type, types);
+			func_def.params.start = var_decls[func_def.params.start];
+			func_def.block = move_index(func_def.block, blocks);
+			return func_def;
+		});
+
+		keep_marked(this->array<Conditional>(), conditionals, [&](Conditional conditional){
+			conditional.cond = move_expr(conditional.cond);
+			conditional.then_block = move_index(conditional.then_block, blocks);
+			conditional.else_block = move_stmt(conditional.else_block);
+			return conditional;
+		});
+
+		keep_marked(this->array<Expr>(), expr_lists, move_expr);
+		keep_marked(this->array<Stmt>(), stmt_lists, move_stmt);
+
+		for(auto& stmt : this->statements){
+			stmt = move_stmt(stmt);
+		}
+
+		this->tokens.keep(token_indices);
+		return token_indices;
 	};
 
 
 
+	//////////////////////////////////////////////////////////////////////
+	// tokens
+
+	Tokenizer::Token AST::Tree::get_token(Expr expr) const {
+		// binary expressions are reported at their left-most operand
+		while(expr.get_type() == ExprType::Binary){
+			expr = this->get<Binary>(expr).left;
+		}
+
+		switch(expr.get_type()){
+			case ExprType::Id:      return this->get_token(this->get<Id>(expr).token);
+			case ExprType::Literal: return this->get_token(this->get<Literal>(expr).token);
+			default:                return this->get_token(this->get<FuncCall>(expr).id);
+		};
+	};
+
+	Tokenizer::Token AST::Tree::get_token(Stmt stmt) const {
+		switch(stmt.get_type()){
+			case StmtType::Block:        return this->get_token(this->get<Block>(stmt).start);
+			case StmtType::VarDecl:      return this->get_token(this->get<VarDecl>(stmt).id);
+			case StmtType::VarAssign:    return this->get_token(this->get<VarAssign>(stmt).id);
+			case StmtType::FuncCallStmt: return this->get_token(this->get(this->get<FuncCallStmt>(stmt).expr).id);
+			case StmtType::ReturnStmt:   return this->get_token(this->get<ReturnStmt>(stmt).expr);
+			case StmtType::FuncDef:      return this->get_token(this->get<FuncDef>(stmt).id);
+			default:                     return this->get_token(this->get<Conditional>(stmt).cond);
+		};
+	};
 
 	
-};
\ No newline at end of file
+};
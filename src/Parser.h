@@ -1,299 +1,282 @@
 #pragma once
 
 #include "Tokenizer.h"
+#include "Types.h"
 
 namespace Hawk{
 
 	namespace AST{
 
-		//////////////////////////////////////////////////////////////////////
-		// expressions
-
-		enum class ExprType{
-			Id,
-			Keyword,
-			Type,
-			Literal,
-			Param,
-			Params,
-			DefParam,
-			DefParams,
-			FuncCall,
-			Binary,
-		};
-
-		struct Expr{
-			virtual ~Expr(){};
+		// nodes are kept in one array per node type (see Tree) and reference each other by 32-bit index
+		// 	the analyzer and compiler walk the arrays directly, there is no virtual dispatch
 
-			virtual void print(uint ident) = 0;
-			virtual ExprType get_type() = 0;
-		};
+		constexpr uint32_t no_index = ~uint32_t(0);
 
-		struct Id : public Expr {
-			Id(Tokenizer::Token token) : token(token) {};
+		// index into the token table of the Tree (nodes don't hold a copy of the Token)
+		using TokenIndex = uint32_t;
 
-			Tokenizer::Token token;
+		template<typename Node>
+		struct Index{
+			uint32_t value = no_index;
 
-			void print(uint ident) override;
-			ExprType get_type() override { return ExprType::Id; };
+			inline bool is_none() const { return this->value == no_index; };
+			inline bool operator==(const Index&) const = default;
 		};
 
-		struct Keyword : public Expr {
-			Keyword(Tokenizer::Token token) : token(token) {};
-
-			Tokenizer::Token token;
+		// range of a Tree array (nodes for VarDecl params, references for Expr and Stmt lists)
+		template<typename T>
+		struct List{
+			uint32_t start = 0;
+			uint32_t size = 0;
 
-			void print(uint ident) override;
-			ExprType get_type() override { return ExprType::Keyword; };
+			// only meaningful for node lists
+			inline Index<T> index(uint32_t i) const { return Index<T>(this->start + i); };
 		};
 
-		struct Type : public Expr {
-			Type(Tokenizer::Token token) : token(token) {};
-
-			Tokenizer::Token token;
 
-			void print(uint ident) override;
-			ExprType get_type() override { return ExprType::Type; };
+		enum class ExprType : uint8_t {
+			Id,
+			Literal,
+			FuncCall,
+			Binary,
 		};
 
-		struct Literal : public Expr {
-			Literal(Tokenizer::Token token) : token(token) {};
-
-			Tokenizer::Token token;
-
-			void print(uint ident) override;
-			ExprType get_type() override { return ExprType::Literal; };
+		enum class StmtType : uint8_t {
+			Block,
+			VarDecl,
+			FuncCallStmt,
+			FuncDef,
+			VarAssign,
+			ReturnStmt,
+			Conditional,
 		};
 
 
-		struct Param : public Expr {
-			~Param(){ delete this->expr; };
-
-			Expr* expr;
+		// reference to a node of any of the types in NodeType
+		// 	the type is stored inline (top 4 bits), so switching on it doesn't touch the node
+		template<typename NodeType>
+		struct Ref{
+			static constexpr uint32_t index_bits = 28;
+			static constexpr uint32_t index_mask = (1u << index_bits) - 1;
 
-			void print(uint ident) override;
-			ExprType get_type() override { return ExprType::Param; };
-		};
+			uint32_t value = no_index;
 
-		struct Params : public Expr {
-			Params(Tokenizer::Token token): start(token) {};
-			~Params(){
-				for(auto* param : this->params){
-					delete param;
-				}
-			};
+			Ref() = default;
+			Ref(NodeType type, uint32_t index) : value((uint32_t(type) << index_bits) | index) {};
 
-			std::vector<Param*> params;
-			Tokenizer::Token start;
+			template<typename Node>
+			Ref(Index<Node> index) : Ref(Node::node_type, index.value) {};
 
-			void print(uint ident) override;
-			ExprType get_type() override { return ExprType::Params; };
+			inline NodeType get_type() const { return NodeType(this->value >> index_bits); };
+			inline uint32_t index() const { return this->value & index_mask; };
+			inline bool is_none() const { return this->value == no_index; };
 		};
 
-		struct DefParam : public Expr {
-			DefParam(Id* id, Type* type) : id(id), type(type) {};
-			~DefParam(){
-				delete this->id;
-				delete this->type;
-			};
-
-			Id* id;
-			Type* type;
+		using Expr = Ref<ExprType>;
+		using Stmt = Ref<StmtType>;
 
-			void print(uint ident) override;
-			ExprType get_type() override { return ExprType::DefParam; };
-		};
 
-		struct DefParams : public Expr {
-			DefParams(Tokenizer::Token token): start(token) {};
-			~DefParams(){
-				for(auto* param : this->params){
-					delete param;
-				}
-			};
 
-			std::vector<DefParam*> params;
-			Tokenizer::Token start;
+		//////////////////////////////////////////////////////////////////////
+		// expressions
 
-			void print(uint ident) override;
-			ExprType get_type() override { return ExprType::Params; };
+		struct Id{
+			static constexpr auto node_type = ExprType::Id;
+			TokenIndex token;
 		};
 
-		struct FuncCall : public Expr {
-			FuncCall(Id* id, Params* params) : id(id), params(params) {};
-			~FuncCall(){
-				delete this->id;
-				delete this->params;
-			};
-
-			Id* id;
-			Params* params;
-
-
-			void print(uint ident) override;
-			ExprType get_type() override { return ExprType::FuncCall; };
+		struct Type{
+			TokenIndex token;
 		};
 
+		struct Literal{
+			static constexpr auto node_type = ExprType::Literal;
+			TokenIndex token;
+		};
 
-		struct Binary : public Expr {
-			Binary(Expr* left, Tokenizer::Token op, Expr* right)
-				: left(left), op(op), right(right) {};
-			~Binary(){
-				delete this->left;
-				delete this->right;
-			};
+		struct FuncCall{
+			static constexpr auto node_type = ExprType::FuncCall;
+			Index<Id> id;
+			List<Expr> params;
+		};
 
-			Expr* left;
-			Tokenizer::Token op;
-			Expr* right;
+		struct Binary{
+			static constexpr auto node_type = ExprType::Binary;
+			Expr left;
+			Expr right;
+			TokenIndex op;
 
 			// value set by semantic analyzer
-			Type* type = nullptr;
-
-
-			void print(uint ident) override;
-			ExprType get_type() override { return ExprType::Binary; };
+			TypeId type = types::none;
 		};
 
 
-	
+
 		//////////////////////////////////////////////////////////////////////
 		// statements
 
-		enum class StmtType{
-			Block,
-			VarDecl,
-			FuncCallStmt,
-			FuncDef,
-			VarAssign,
-			ReturnStmt,
-			Conditional,
+		struct Block{
+			static constexpr auto node_type = StmtType::Block;
+			List<Stmt> stmts;
+			TokenIndex start;
 		};
 
-		struct Stmt{
-			virtual ~Stmt(){};
+		// function parameters are VarDecls without a value
+		struct VarDecl{
+			static constexpr auto node_type = StmtType::VarDecl;
+			Index<Id> id;
+			Index<Type> type; // none if inferred
+			Expr value;
 
-			virtual void print(uint ident) = 0;
-			virtual StmtType get_type() = 0;
+			// value set by semantic analyzer
+			TypeId type_id = types::none;
 		};
 
+		struct VarAssign{
+			static constexpr auto node_type = StmtType::VarAssign;
+			Index<Id> id;
+			Expr value;
+		};
 
-		struct Block : public Stmt {
-			Block(Tokenizer::Token token): start(token) {};
-			~Block(){
-				for(auto* stmt : this->stmts){
-					delete stmt;
-				}
-			};
+		struct FuncCallStmt{
+			static constexpr auto node_type = StmtType::FuncCallStmt;
+			Index<FuncCall> expr;
+		};
+
+		struct ReturnStmt{
+			static constexpr auto node_type = StmtType::ReturnStmt;
+			Expr expr;
+		};
 
-			std::vector<Stmt*> stmts;
-			Tokenizer::Token start;
+		struct FuncDef{
+			static constexpr auto node_type = StmtType::FuncDef;
+			Index<Id> id;
+			Index<Type> return_type; // none if inferred
+			List<VarDecl> params;
+			Index<Block> block;
 
-			void print(uint ident) override;
-			StmtType get_type() override { return StmtType::Block; };
+			// value set by semantic analyzer
+			TypeId return_type_id = types::none;
 		};
 
+		struct Conditional{
+			static constexpr auto node_type = StmtType::Conditional;
+			Expr cond;
+			Index<Block> then_block;
+			Stmt else_block;
+			// must be AST::Conditional or AST::Block
+		};
 
 
-		struct VarDecl : public Stmt {
-			VarDecl(Id* id, Type* type, Expr* value): id(id), type(type), value(value) {};
-			~VarDecl(){
-				delete this->id;
-				// this causes a segfault for some reason
-				// delete this->type;
-				delete this->value;
-			};
 
-			Id* id;
-			Type* type;
-			Expr* value;
+		//////////////////////////////////////////////////////////////////////
+		// tree
 
+		class Tree{
+			public:
+				Tree() = default;
+				Tree(std::string_view source) : tokens(source) {};
+				~Tree() = default;
 
-			void print(uint ident) override;
-			StmtType get_type() override { return StmtType::VarDecl; };
-		};
 
-		struct VarAssign : public Stmt {
-			VarAssign(Id* id, Expr* value): id(id), value(value) {};
-			~VarAssign(){
-				delete this->id;
-				delete this->value;
-			};
+				template<typename Node>
+				Index<Node> add(const Node& node){
+					auto& nodes = this->array<Node>();
+					nodes.emplace_back(node);
+					return Index<Node>(uint32_t(nodes.size() - 1));
+				};
 
-			Id* id;
-			Expr* value;
+				template<typename T>
+				List<T> add_list(std::span<const T> items){
+					auto& array = this->array<T>();
+					auto list = List<T>(uint32_t(array.size()), uint32_t(items.size()));
+					array.insert(array.end(), items.begin(), items.end());
+					return list;
+				};
 
 
-			void print(uint ident) override;
-			StmtType get_type() override { return StmtType::VarAssign; };
-		};
+				template<typename Node> Node& get(Index<Node> index){ return this->array<Node>()[index.value]; };
+				template<typename Node> const Node& get(Index<Node> index) const { return this->array<Node>()[index.value]; };
 
+				template<typename Node> Node& get(Expr expr){ return this->array<Node>()[expr.index()]; };
+				template<typename Node> const Node& get(Expr expr) const { return this->array<Node>()[expr.index()]; };
 
-		struct FuncCallStmt : public Stmt {
-			FuncCallStmt(FuncCall* expr) : expr(expr) {};
-			~FuncCallStmt(){
-				delete this->expr;
-			};
+				template<typename Node> Node& get(Stmt stmt){ return this->array<Node>()[stmt.index()]; };
+				template<typename Node> const Node& get(Stmt stmt) const { return this->array<Node>()[stmt.index()]; };
 
-			FuncCall* expr;
+				// every node of a type
+				template<typename Node> std::span<Node> all(){ return this->array<Node>(); };
+				template<typename Node> std::span<const Node> all() const { return this->array<Node>(); };
 
-			void print(uint ident) override;
-			StmtType get_type() override { return StmtType::FuncCallStmt; };
-		};
+				template<typename T> std::span<T> get(List<T> list){ return std::span<T>(this->array<T>()).subspan(list.start, list.size); };
+				template<typename T> std::span<const T> get(List<T> list) const { return std::span<const T>(this->array<T>()).subspan(list.start, list.size); };
 
+				inline TokenIndex add_token(const Tokenizer::Token& token){
+					this->tokens.push_back(token);
+					return TokenIndex(this->tokens.size() - 1);
+				};
 
-		struct ReturnStmt : public Stmt {
-			ReturnStmt(Expr* expr) : expr(expr) {};
-			~ReturnStmt(){
-				delete this->expr;
-			};
+				inline Tokenizer::Token get_token(TokenIndex token) const { return this->tokens.get(token); };
+				inline Tokenizer::Token get_token(Index<Id> id) const { return this->tokens.get(this->get(id).token); };
+				inline Tokenizer::Token get_token(Index<Type> type) const { return this->tokens.get(this->get(type).token); };
 
-			Expr* expr;
+				// the token a node is reported at in errors
+				Tokenizer::Token get_token(Expr expr) const;
+				Tokenizer::Token get_token(Stmt stmt) const;
 
-			void print(uint ident) override;
-			StmtType get_type() override { return StmtType::ReturnStmt; };
-		};
 
+				void print(Expr expr, uint ident) const;
+				void print(Stmt stmt, uint ident) const;
 
-		struct FuncDef : public Stmt {
-			FuncDef(Id* id, Type* return_type, DefParams* params, Block* block)
-				: id(id), return_type(return_type), params(params), block(block) {};
-			~FuncDef(){
-				delete this->id;
-				delete this->return_type;
-				delete this->params;
-				delete this->block;
-			};
 
-			Id* id;
-			Type* return_type;
-			DefParams* params;
-			Block* block;
+				// raw copy of every array, nodes are trivially copyable and only reference each other by index
+				// 	read() replaces the contents of the tree, the tokens are looked up in the source the tree was made with
+				void write(std::string& output) const;
+				bool read(std::string_view& input, symbols::Interner& interner);
 
+				// adds the nodes of `other` to the end (its statements after the ones already here), mapping its SymbolIds through `symbol_map`
+				// 	every index in them is moved past the nodes already here
+				void append(const Tree& other, std::span<const SymbolId> symbol_map);
 
-			void print(uint ident) override;
-			StmtType get_type() override { return StmtType::FuncDef; };
-		};
+				// drops the nodes and tokens that no statement references (the ones of statements replaced by Parser::reparse)
+				// 	the rest keep their order, returns the new index of every old token index (and of the end)
+				std::vector<TokenIndex> compact();
 
+			public:
+				// top level statements, in order
+				std::vector<Stmt> statements;
 
+				// every token referenced by a node, in the order the nodes were added
+				Tokenizer::TokenBuffer tokens;
 
-		struct Conditional : public Stmt {
-			Conditional(Expr* cond, Block* then, Stmt* else_block)
-				: cond(cond), then_block(then), else_block(else_block) {};
-			~Conditional(){
-				delete this->cond;
-				delete this->then_block;
-				delete this->else_block;
-			};
+			private:
+				template<typename T> std::vector<T>& array(){ return std::get<std::vector<T>>(this->arrays); };
+				template<typename T> const std::vector<T>& array() const { return std::get<std::vector<T>>(this->arrays); };
 
-			Expr* cond;
-			Block* then_block;
-			Stmt* else_block;
-			// must be AST::Conditional or AST::Block
+				void print(Index<Id> id, uint ident) const;
+				void print(Index<Type> type, uint ident) const;
+				void print(List<Expr> params, uint ident) const;
 
+			private:
+				std::tuple<
+					std::vector<Id>,
+					std::vector<Type>,
+					std::vector<Literal>,
+					std::vector<FuncCall>,
+					std::vector<Binary>,
 
-			void print(uint ident) override;
-			StmtType get_type() override { return StmtType::Conditional; };
+					std::vector<Block>,
+					std::vector<VarDecl>,
+					std::vector<VarAssign>,
+					std::vector<FuncCallStmt>,
+					std::vector<ReturnStmt>,
+					std::vector<FuncDef>,
+					std::vector<Conditional>,
+
+					// child lists
+					std::vector<Expr>,
+					std::vector<Stmt>
+				> arrays;
 		};
 
 
@@ -303,23 +286,50 @@ namespace Hawk{
 
 	class Parser{
 		public:
-			Parser(const std::vector<Tokenizer::Token>& token_vector);
-			~Parser();
+			Parser(const Tokenizer::TokenBuffer& token_buffer, const CharacterStream& char_stream);
+
+			// streaming, tokens are lexed as the parser needs them
+			Parser(Tokenizer& tokenizer);
+			~Parser() = default;
 
 			void start();
 
 			inline bool success() const { return !this->has_errored; };
 
+
+			// bytes [start, old_end) of the file were replaced by [start, new_end)
+			struct Edit{
+				uint start;
+				uint old_end;
+				uint new_end;
+			};
+
+			// smallest edit that turns `old_source` into `new_source`
+			static Edit find_edit(std::string_view old_source, std::string_view new_source);
+
+			// only the top level statements that the edit touched are lexed and parsed again, the others are kept (and moved by the edit)
+			// 	the nodes of the statements that were replaced are dropped from the tree
+			// 	`char_stream` is the whole file after the edit, it has to outlive the tree (like the one it was parsed from)
+			// 	the tree must not have been through the SemanticAnalyzer yet
+			// 	if the last parse failed, the whole file is parsed again
+			void reparse(CharacterStream& char_stream, Edit edit);
+
+			// the source of the top level statement `i` (same order as tree.statements)
+			std::string_view get_statement_source(size_t i) const;
+
 			static std::string print_token(const Tokenizer::Token& token);
 			static std::string print_token(Tokenizer::Token::Type token);
 		public:
-			std::vector<AST::Stmt*> statements;
+			AST::Tree tree;
 
 		private:
 			std::string print_token();
 
-			Tokenizer::Token get();
-			Tokenizer::Token peek(uint offset = 0);
+			const Tokenizer::Token& get();
+			const Tokenizer::Token& peek(uint offset = 0);
+			Tokenizer::Token::Type peek_kind(uint offset = 0);
+			bool has_tokens();
+			void pull_tokens();
 
 			void error(const Tokenizer::Token& token);
 			void error();
@@ -342,120 +352,169 @@ namespace Hawk{
 			// 		FuncDef      ';'
 			// 		ReturnStmt   ';'
 			// 		Conditional  ';'
-			AST::Stmt* parse_stmt();
+			AST::Stmt parse_stmt();
+
+			// parse_stmt() at the top level, also keeps its span for reparse()
+			void parse_top_level_stmt();
 
 
 			// Block
 			// 		'{' '}'
 			// 		'{' Stmt+ '}'
-			AST::Block* parse_block();
+			AST::Index<AST::Block> parse_block();
 
 
 			// VarDecl
 			// 		Id ':'      '=' Expr
 			// 		Id ':' Type '=' Expr
 			// 		Id ':' Type
-			AST::VarDecl* parse_var_decl();
+			AST::Index<AST::VarDecl> parse_var_decl();
 
 
 			// VarAssign
 			// 		Id '=' Expr
-			AST::VarAssign* parse_var_assign();
+			AST::Index<AST::VarAssign> parse_var_assign();
 
 
 			// FuncCallStmt
 			// 		FuncCall
-			AST::FuncCallStmt* parse_func_call_stmt();
+			AST::Index<AST::FuncCallStmt> parse_func_call_stmt();
 
 
 			// ReturnStmt
 			// 		Expr
-			AST::ReturnStmt* parse_return_stmt();
+			AST::Index<AST::ReturnStmt> parse_return_stmt();
 
 
 			// FuncDef
 			// 		'func' Id DefParams Type Block
 			// 		'func' Id DefParams      Block
-			AST::FuncDef* parse_func_def();
+			AST::Index<AST::FuncDef> parse_func_def();
 
 			// Conditional
 			// 		'if' '(' Expr ')' Block
 			// 		'if' '(' Expr ')' Block 'else' Block
 			// 		'if' '(' Expr ')' Block 'else' Conditional
-			AST::Conditional* parse_conditional();
+			AST::Index<AST::Conditional> parse_conditional();
+
+			// 'if' '(' Expr ')'
+			AST::Expr parse_conditional_cond();
 
 
 
 
 
 			// expression binary parsing
-			AST::Expr* parse_expr();
-			AST::Expr* parse_op(AST::Expr* left, uint prec);
-			uint get_op_prec(const Tokenizer::Token& op);
+			AST::Expr parse_expr();
+			AST::Expr parse_op(AST::Expr left, uint prec);
+			uint get_op_prec(Tokenizer::Token::Type op);
 
 			// Term
 			// 		Literal
 			// 		Id
 			// 		FuncCall
-			AST::Expr* parse_term();
+			AST::Expr parse_term();
 
 
 			// FuncCall
 			// 		Id Params
-			AST::FuncCall* parse_func_call();
+			AST::Index<AST::FuncCall> parse_func_call();
 
 
 			// Params
 			// 		'(' ')'
 			// 		'(' Param ')'
 			// 		'(' (Param ',')+ Param ')'
-			AST::Params* parse_params();
+			AST::List<AST::Expr> parse_params();
 
 
 			// Param
 			// 		Expr
-			AST::Param* parse_param();
+			AST::Expr parse_param();
 
 
 			// DefParams
 			// 		'(' ')'
 			// 		'(' DefParam ')'
 			// 		'(' (DefParam ',')+ DefParam ')'
-			AST::DefParams* parse_def_params();
+			AST::List<AST::VarDecl> parse_def_params();
 
 
 			// DefParam
 			// 		Id ':' Type
-			AST::DefParam* parse_def_param();
+			AST::Index<AST::VarDecl> parse_def_param();
 
 
 			// Type
 			// 		'type_keyword'
 			// 		Id
-			AST::Type* parse_type();
+			AST::Index<AST::Type> parse_type();
 
 
 			// Literal
 			// 		literal_int
 			// 		literal_float
 			// 		literal_bool
-			AST::Literal* parse_literal();
+			AST::Index<AST::Literal> parse_literal();
 
 
 			// Id...
-			AST::Id* parse_id();
+			AST::Index<AST::Id> parse_id();
 
 
 			//////////////////////////////////////////////////////////////////////
 			// is
 
-			bool is_operator(Tokenizer::Token& token);
+			bool is_operator(Tokenizer::Token::Type token_type);
+
+
+			// child lists are collected on a scratch stack (nested lists push on top), then copied into the tree in one piece
+			template<typename T>
+			AST::List<T> pop_scratch(std::vector<T>& scratch, size_t start){
+				auto list = this->tree.add_list(std::span<const T>(scratch.data() + start, scratch.size() - start));
+				scratch.resize(start);
+				return list;
+			};
 
 
 		private:
-			const std::vector<Tokenizer::Token>& tokens;
+			const Tokenizer::TokenBuffer* tokens = nullptr;
+			const CharacterStream* stream = nullptr;
 			uint i = 0;
 			bool has_errored = false;
+
+			std::vector<AST::Stmt> stmt_scratch;
+			std::vector<AST::Expr> expr_scratch;
+			std::vector<AST::TokenIndex> op_scratch;
+
+			// blocks parse_block() has opened but not closed yet
+			struct OpenBlock{
+				AST::TokenIndex start; // the '{'
+				size_t scratch_start;  // its statements on stmt_scratch
+				AST::Expr cond;        // of the arm it's the then block of, none for an else block (or the block parse_block() was called for)
+				AST::Index<AST::Conditional> last_arm; // the arm before it in the chain
+				AST::Stmt first_arm;   // of the chain
+			};
+			std::vector<OpenBlock> open_blocks;
+
+			// one per top level statement (same order as tree.statements)
+			struct StatementSpan{
+				uint start = 0; // position of the first token
+				uint end = 0;   // end of the ';'
+				AST::TokenIndex first_token = 0; // the tree tokens of a statement are next to each other
+				AST::TokenIndex end_token = 0;
+			};
+
+			std::vector<StatementSpan> statement_spans;
+
+			// ring buffer of peek(-1) through peek(max_lookahead)
+			// 	filled from `tokens`, or when streaming, by the tokenizer
+			static constexpr uint max_lookahead = 1;
+			static constexpr uint window_mask = 3;
+
+			Tokenizer* tokenizer = nullptr;
+			std::array<Tokenizer::Token, window_mask + 1> window{};
+			uint lexed = 0; // index of the next token to put in the window
 	};
 	
 };
\ No newline at end of file
@@ -5,106 +5,95 @@
 namespace Hawk{
 
 
-	SemanticAnalyzer::SemanticAnalyzer(const std::vector<AST::Stmt*>& stmts) : stmts(stmts) {
+	SemanticAnalyzer::SemanticAnalyzer(AST::Tree& ast, const SourceFiles& source_files, Diagnostics& diagnostics, uint thread_count)
+		: const_evaluator(ast, this->functions), tree(ast), files(source_files), diagnostics(diagnostics), thread_count(thread_count) {
 		this->enter_scope();
-
-		#define GENERATE_TYPE(type) { \
-			auto new_token = Tokenizer::Token(TokenType::generated); \
-			new_token.value = type; \
-			this->types[type] = new AST::Type(new_token); \
-		}
-
-		GENERATE_TYPE("void");
-		GENERATE_TYPE("int");
-		GENERATE_TYPE("float");
-		GENERATE_TYPE("bool");
-
-
-		#undef GENERATE_TYPE
 	};
 
-	SemanticAnalyzer::~SemanticAnalyzer(){
-		for(auto [name, type] : this->types){
-			delete type;
-		}
-	};
 
+	using Code = Diagnostics::Code;
+	using Location = Diagnostics::Location;
 
 
 
-	#define CONTINUE() if(this->error_count != 0){return;};
+	#define CONTINUE() if(this->diagnostics.get_error_count() != 0){return;};
 	void SemanticAnalyzer::begin(){
+		this->resolve_written_types();
 		this->get_all_globals();
 		CONTINUE();
-		this->global_var_type_inference_attempt();
+		this->check_declarations();
 		CONTINUE();
-		this->func_checking_type_inference_attempt();
-		CONTINUE();
-		this->final_check_all();
-		
+		this->const_evaluator.fold_calls();
+		this->check_global_values();
 	};
 	#undef CONTINUE
 
 
 
+	// the types written in the source, the others are inferred
+	void SemanticAnalyzer::resolve_written_types(){
+		for(auto& var_decl : this->tree.all<AST::VarDecl>()){
+			if(!var_decl.type.is_none()){
+				var_decl.type_id = this->types.get(this->tree.get_token(var_decl.type).symbol);
+			}
+		}
+
+		for(auto& func_def : this->tree.all<AST::FuncDef>()){
+			if(!func_def.return_type.is_none()){
+				func_def.return_type_id = this->types.get(this->tree.get_token(func_def.return_type).symbol);
+			}
+		}
+	};
+
+
+
 	void SemanticAnalyzer::get_all_globals(){
-		for(auto* stmt : this->stmts){
-			switch(stmt->get_type()){
+		for(auto stmt : this->tree.statements){
+			switch(stmt.get_type()){
 
 				case AST::StmtType::VarDecl: {
-					auto* var_decl = static_cast<AST::VarDecl*>(stmt);
-					std::string var_name = var_decl->id->token.value;
+					auto var_decl = AST::Index<AST::VarDecl>(stmt.index());
+					auto var_decl_id = this->tree.get_token(this->tree.get(var_decl).id);
+					SymbolId var_name = var_decl_id.symbol;
 
 					// check if already defined
 					if(this->global_vars.contains(var_name)){
-						auto already_defined = this->global_vars[var_name]->id->token;
-						cmd::error("Global variable ({}) was already defined at <{}, {}>", var_name, already_defined.line, already_defined.collumn);
-						this->error(var_decl->id->token);
+						auto already_defined = this->tree.get_token(this->tree.get(this->global_vars[var_name]).id);
+						this->report(Code::global_var_redefined, var_decl_id, {already_defined.value, Location(already_defined)});
 					}else{
 						this->global_vars[var_name] = var_decl;
 					}
 
 
 				} break; case AST::StmtType::FuncDef: {
-					auto func_def = static_cast<AST::FuncDef*>(stmt);
-					std::string func_name = func_def->id->token.value;
+					auto func_def = AST::Index<AST::FuncDef>(stmt.index());
+					auto func_def_id = this->tree.get_token(this->tree.get(func_def).id);
+					SymbolId func_name = func_def_id.symbol;
 
 					if(this->functions.contains(func_name)){
-						auto first_definition = this->global_vars[func_name]->id->token;
-						this->error(func_def->id->token);
-						cmd::error("\tFunction ({}) was already defined at <{}, {}>", func_name, first_definition.line, first_definition.collumn);
+						auto first_definition = this->tree.get_token(this->tree.get(this->functions[func_name]).id);
+						this->report(Code::function_redefined, func_def_id, {first_definition.value, Location(first_definition)});
 					}else{
 						this->functions[func_name] = func_def;
 					}
 
 				} break; case AST::StmtType::VarAssign: {
-					auto* var_assign = static_cast<AST::VarAssign*>(stmt);
-					this->error(var_assign->id->token);
-					cmd::error("\tVariable assignments cannot be in global scope");
+					this->report(Code::var_assign_in_global_scope, stmt);
 
 				}break;case AST::StmtType::FuncCallStmt: {
-					auto* func_call_stmt = static_cast<AST::FuncCallStmt*>(stmt);
-					this->error(func_call_stmt->expr->id->token);
-					cmd::error("\tFunction-call statements cannot be in global scope");
+					this->report(Code::func_call_in_global_scope, stmt);
 
 				}break;case AST::StmtType::Block: {
-					auto* block = static_cast<AST::Block*>(stmt);
-					this->error(block->start);
-					cmd::error("\tBlock statements cannot be alone in global scope");
+					this->report(Code::block_in_global_scope, stmt);
 
 				}break;case AST::StmtType::ReturnStmt: {
-					auto* return_stmt = static_cast<AST::ReturnStmt*>(stmt);
-					this->error(return_stmt->expr);
-					cmd::error("\tReturn statements cannot be in global scope");
+					this->report(Code::return_in_global_scope, stmt);
 
 				}break;case AST::StmtType::Conditional: {
-					auto* conditional_stmt = static_cast<AST::Conditional*>(stmt);
-					this->error(conditional_stmt->cond);
-					cmd::error("\tConditional statements cannot be in global scope");
+					this->report(Code::conditional_in_global_scope, stmt);
 
 				}break; default: {
-					cmd::fatal("Compiler Fail: Received unknown statement type (SemanticAnalyzer, line: {})", __LINE__);
-					this->error_count += 1;
+					this->report(Code::unknown_statement, nullptr, {__LINE__});
 				}
 
 			};
@@ -113,295 +102,558 @@ namespace Hawk{
 
 
 
+	// globals are set before the program runs, so their value has to be known by the Compiler
+	// 	a call is only known if the ConstEvaluator could run it (it reads no globals, doesn't call printf, ends within the limits)
+	void SemanticAnalyzer::check_global_values(){
+		for(auto [name, var_decl] : this->global_vars){
+			const auto& var_decl_node = this->tree.get(var_decl);
+			auto value = var_decl_node.value;
+			if(value.is_none()){ continue; }
+
+			bool is_constant = false;
+			switch(value.get_type()){
+				case AST::ExprType::Literal:
+				case AST::ExprType::Id:       is_constant = true; break;
+				case AST::ExprType::FuncCall: is_constant = this->const_evaluator.get_folded(AST::Index<AST::FuncCall>(value.index())) != nullptr; break;
+				default: break;
+			};
+
+			if(!is_constant){
+				this->report(Code::global_value_not_constant, value, {this->tree.get_token(var_decl_node.id).value});
+			}
+		}
+	};
+
+
+
+
+	// globals first, so the output keeps the order of the old global pass
+	// 	every type that isn't written is inferred on demand, so the order of the declarations doesn't change the result
+	// 	functions with a known return type (written, or kept from the last compile) only read types,
+	// 	so they're checked last, on worker threads (each with its own scopes and stacks)
+	void SemanticAnalyzer::check_declarations(){
+		auto& declarations = *this->declarations;
+
+		declarations.by_var_decl.assign(this->tree.all<AST::VarDecl>().size(), Declarations::none);
+		declarations.by_func_def.assign(this->tree.all<AST::FuncDef>().size(), Declarations::none);
+		declarations.keep_dependencies = this->signatures != nullptr;
 
-	void SemanticAnalyzer::global_var_type_inference_attempt(){
 		for(auto [name, var_decl] : this->global_vars){
+			declarations.by_var_decl[var_decl.value] = uint32_t(declarations.list.size());
+			declarations.list.push_back({AST::Stmt(var_decl), Declarations::State::pending});
+
+			// globals can be used before they're declared
 			this->add_to_scope(name, var_decl);
+		}
+
+		for(auto [name, func_def] : this->functions){
+			declarations.by_func_def[func_def.value] = uint32_t(declarations.list.size());
+			declarations.list.push_back({AST::Stmt(func_def), Declarations::State::pending});
+		}
+
 
-			if(var_decl->type != nullptr){ break; };
+		// the hash of the source of every declaration (compile server)
+		auto decl_hashes = std::vector<size_t>();
 
-			if(var_decl->value->get_type() == AST::ExprType::Literal){
-				var_decl->type = this->get_expr_type(var_decl->value);
-			}else if(var_decl->value->get_type() == AST::ExprType::Id){
-				auto id_token = static_cast<AST::Id*>(var_decl->value)->token;
+		if(this->signatures != nullptr){
+			decl_hashes.resize(declarations.list.size());
 
+			for(size_t i = 0; i < this->tree.statements.size(); i++){
+				auto stmt = this->tree.statements[i];
+				if(stmt.get_type() != AST::StmtType::VarDecl && stmt.get_type() != AST::StmtType::FuncDef){ continue; }
 
-				if(id_token.value == name){
-					this->error(id_token);
-					cmd::error("\tCannot set variable to self in a declaration");
+				// a name defined again has no declaration of its own (the SemanticAnalyzer reports it)
+				if(auto decl = this->find_decl(stmt); decl != Declarations::none){
+					decl_hashes[decl] = this->statement_hashes[i];
+				}
+			}
+
+			this->keep_return_types(decl_hashes);
+		}
+
+
+		// the diagnostics of a check go to its declaration
+		// 	a check that got blocked on a pending declaration leaves no diagnostics behind
+		// 	its dependencies are kept, the check done again doesn't visit the operands of the binaries it already typed
+		auto check = [&](SemanticAnalyzer& analyzer, uint32_t i){
+			auto& decl = declarations.list[i];
+			decl.diagnostics.clear();
+
+			analyzer.current_decl = i;
+			analyzer.current_diagnostics = &decl.diagnostics;
+			decl.stop = !analyzer.check_decl(i);
+			analyzer.current_decl = Declarations::none;
+			analyzer.current_diagnostics = nullptr;
+		};
+
+
+		// set aside before any check, the checks infer the return types of the other functions
+		auto known_return_types = std::vector<uint32_t>();
+		auto is_known = std::vector<bool>(declarations.list.size(), false);
+
+		for(uint32_t i = 0; i < declarations.list.size(); i++){
+			auto stmt = declarations.list[i].stmt;
+			if(stmt.get_type() != AST::StmtType::FuncDef){ continue; }
+
+			const auto& func_def = this->tree.get<AST::FuncDef>(stmt);
+			if(!func_def.return_type.is_none() || func_def.return_type_id != types::none){
+				known_return_types.push_back(i);
+				is_known[i] = true;
+			}
+		}
+
+
+		// a blocked check is pushed back under the declaration it needs (which becomes in_progress)
+		// 	each declaration is pushed once, so this ends even if the types depend on each other
+		auto check_stack = std::vector<uint32_t>();
+
+		for(uint32_t i = 0; i < declarations.list.size(); i++){
+			if(is_known[i] || declarations.list[i].state == Declarations::State::checked){ continue; }
+
+			check_stack.push_back(i);
+			while(!check_stack.empty()){
+				auto current = check_stack.back();
+				declarations.list[current].state = Declarations::State::in_progress;
+
+				check(*this, current);
+
+				if(this->blocked_on != Declarations::none){
+					check_stack.push_back(std::exchange(this->blocked_on, Declarations::none));
 					continue;
 				}
 
-				var_decl->type = this->get_expr_type(var_decl->value);
+				declarations.list[current].state = Declarations::State::checked;
+				check_stack.pop_back();
+			};
+		}
+
+
+		// a thread isn't worth starting for fewer functions
+		constexpr size_t functions_per_thread = 64;
+		const size_t thread_count = std::clamp<size_t>(known_return_types.size() / functions_per_thread, 1, this->thread_count);
+
+		auto next_function = std::atomic<size_t>(0);
+		auto check_functions = [&](SemanticAnalyzer& analyzer){
+			for(size_t i = next_function++; i < known_return_types.size(); i = next_function++){
+				check(analyzer, known_return_types[i]);
 			}
+		};
+
+		auto workers = std::vector<std::unique_ptr<SemanticAnalyzer>>();
+		auto threads = std::vector<std::thread>();
+		for(size_t i = 1; i < thread_count; i++){
+			auto& worker = workers.emplace_back(std::make_unique<SemanticAnalyzer>(this->tree, this->files, this->diagnostics));
+			worker->functions = this->functions;
+			worker->types = this->types;
+			worker->scopes = this->scopes;
+			worker->declarations = this->declarations;
+
+			threads.emplace_back(check_functions, std::ref(*worker));
+		}
+		check_functions(*this);
 
+		for(auto& thread : threads){
+			thread.join();
+		}
+
+		for(auto i : known_return_types){
+			declarations.list[i].state = Declarations::State::checked;
+		}
+
+
+		for(const auto& decl : declarations.list){
+			this->diagnostics.append(decl.diagnostics);
+			if(decl.stop){ break; }
+		}
+
+		if(this->signatures != nullptr && this->diagnostics.get_error_count() == 0){
+			this->save_signatures(decl_hashes);
 		}
 	};
 
 
 
-	void SemanticAnalyzer::func_checking_type_inference_attempt(){
-		for(auto [name, func_def] : this->functions){
-			
-			this->enter_scope();
+	// the declarations of the last compile that are gone or have other source are stale, and so is everything that read their types (directly or not)
+	// 	the functions that aren't stale get back the return type they had
+	void SemanticAnalyzer::keep_return_types(const std::vector<size_t>& decl_hashes){
+		const auto& previous = this->signatures->decls;
 
-			for(auto* param : func_def->params->params){
-				auto param_name = param->id->token.value;
+		auto current = std::vector<uint32_t>(previous.size(), Declarations::none);
+		auto stale = std::vector<bool>(previous.size(), false);
+		auto stack = std::vector<uint32_t>();
 
-				if(this->in_current_scope(param_name)){
-					auto first_definition = this->in_current_scope(param_name)->id->token;
-					this->error(param->id);
-					cmd::error("\tParameter({}) was already defined at <{}, {}> ", param_name, first_definition.line, first_definition.collumn);
-					return;
-				}
+		for(uint32_t i = 0; i < previous.size(); i++){
+			const auto& decl = previous[i];
 
-				if(this->in_scope(param_name)){
-					auto first_definition = this->in_scope(param_name)->id->token;
-					this->warning(param->id);
-					cmd::warning("\tParameter ({}) was already defined in a parent scope at <{}, {}> ", param_name, first_definition.line, first_definition.collumn);
-					cmd::warning("\tThis may cause unexpected behavior");
+			if(decl.is_function){
+				if(auto* func_def = this->functions.find(decl.name); func_def != nullptr){
+					current[i] = this->find_decl(AST::Stmt(*func_def));
 				}
+			}else{
+				if(auto* var_decl = this->global_vars.find(decl.name); var_decl != nullptr){
+					current[i] = this->find_decl(AST::Stmt(*var_decl));
+				}
+			}
 
-				this->add_to_scope(param_name, new AST::VarDecl(param->id, param->type, nullptr));
+			if(current[i] == Declarations::none || decl_hashes[current[i]] != decl.source_hash){
+				stale[i] = true;
+				stack.push_back(i);
+			}
+		}
 
+
+		// the dependents of decl are dependents[first_dependent[decl] .. first_dependent[decl + 1]]
+		auto first_dependent = std::vector<uint32_t>(previous.size() + 1, 0);
+		for(const auto& decl : previous){
+			for(auto dependency : decl.dependencies){
+				first_dependent[dependency] += 1;
 			}
+		}
+		std::exclusive_scan(first_dependent.begin(), first_dependent.end(), first_dependent.begin(), uint32_t(0));
 
-			for(auto* stmt : func_def->block->stmts){
-				this->func_checking_type_inference_attempt_impl(func_def, stmt);
+		auto dependents = std::vector<uint32_t>(first_dependent.back());
+		auto next_dependent = first_dependent;
+		for(uint32_t i = 0; i < previous.size(); i++){
+			for(auto dependency : previous[i].dependencies){
+				dependents[next_dependent[dependency]++] = i;
 			}
+		}
 
-			if(func_def->return_type == nullptr){
-				if(this->found_return_stmt){
-					this->error(func_def);
-					cmd::error("\tFound return statement in function ({}) with 'void' return type", name);
-				}else{
-					func_def->return_type = this->types["void"];
-				}
-			}else if(!this->found_return_stmt && func_def->return_type->token.value != "void"){
-				this->error(func_def);
-				cmd::error("\tFunction ({}) does not return on all conditional paths", name);
+		while(!stack.empty()){
+			auto decl = stack.back();
+			stack.pop_back();
+
+			for(auto j = first_dependent[decl]; j < first_dependent[decl + 1]; j++){
+				auto dependent = dependents[j];
+				if(stale[dependent]){ continue; }
+				stale[dependent] = true;
+				stack.push_back(dependent);
 			}
+		};
 
-			this->leave_scope();
 
+		for(uint32_t i = 0; i < previous.size(); i++){
+			if(stale[i] || previous[i].return_type == symbols::none){ continue; }
+
+			auto& func_def = this->tree.get<AST::FuncDef>(this->declarations->list[current[i]].stmt);
+			func_def.return_type_id = this->types.get(previous[i].return_type);
+			this->kept_return_types += 1;
 		}
 	};
 
 
-	void SemanticAnalyzer::func_checking_type_inference_attempt_impl(AST::FuncDef* func_def, AST::Stmt* stmt){
-		if(this->found_return_stmt && !this->printed_return_error){
-			this->error(stmt);
-			cmd::error("\tFound code after return stmt");
-			this->printed_return_error = true;
-		}
+	void SemanticAnalyzer::save_signatures(const std::vector<size_t>& decl_hashes){
+		auto& list = this->declarations->list;
+		auto& decls = this->signatures->decls;
+		decls.clear();
 
-		switch(stmt->get_type()){
+		for(uint32_t i = 0; i < list.size(); i++){
+			auto stmt = list[i].stmt;
+			auto& decl = decls.emplace_back(symbols::none, stmt.get_type() == AST::StmtType::FuncDef, decl_hashes[i]);
 
-			//////////////////////////////////////////////////////////////////////
-			// VarDecl
+			if(decl.is_function){
+				const auto& func_def = this->tree.get<AST::FuncDef>(stmt);
+				decl.name = this->tree.get_token(func_def.id).symbol;
 
-			case AST::StmtType::VarDecl: {
-				auto var_decl = static_cast<AST::VarDecl*>(stmt);
-				auto var_name = var_decl->id->token.value;
-				if(this->in_current_scope(var_name)){
-					auto first_definition = this->in_current_scope(var_name)->id->token;
-					this->error(var_decl->id);
-					cmd::error("\tVariable ({}) was already defined at <{}, {}> ", var_name, first_definition.line, first_definition.collumn);
-					return;
+				if(func_def.return_type.is_none() && func_def.return_type_id != types::none){
+					decl.return_type = this->types.get_name(func_def.return_type_id);
 				}
+			}else{
+				decl.name = this->tree.get_token(this->tree.get<AST::VarDecl>(stmt).id).symbol;
+			}
 
-				if(this->in_scope(var_name)){
-					auto first_definition = this->in_scope(var_name)->id->token;
-					this->warning(var_decl->id);
-					cmd::warning("\tVariable ({}) was already defined in a parent scope at <{}, {}> ", var_name, first_definition.line, first_definition.collumn);
-					cmd::warning("\tThis may cause unexpected behavior");
-				}
+			// the analysis is done with them
+			decl.dependencies = std::move(list[i].dependencies);
+		}
+	};
 
-				this->add_to_scope(var_name, var_decl);
 
-				if(var_decl->type != nullptr){ return; };
+	// false if the declarations after it shouldn't be reported
+	bool SemanticAnalyzer::check_decl(uint32_t decl){
+		auto stmt = this->declarations->list[decl].stmt;
+
+		if(stmt.get_type() == AST::StmtType::VarDecl){
+			this->global_var_checking(AST::Index<AST::VarDecl>(stmt.index()));
+			return true;
+		}
 
+		return this->func_checking(AST::Index<AST::FuncDef>(stmt.index()));
+	};
 
 
+	void SemanticAnalyzer::global_var_checking(AST::Index<AST::VarDecl> var_decl){
+		auto& var_decl_node = this->tree.get(var_decl);
+		if(var_decl_node.value.is_none()){ return; }
 
-				if(var_decl->value->get_type() == AST::ExprType::Literal || var_decl->value->get_type() == AST::ExprType::Binary){
-					var_decl->type = this->get_expr_type(var_decl->value);
+		if(var_decl_node.value.get_type() == AST::ExprType::Id){
+			auto id_token = this->tree.get_token(var_decl_node.value);
 
+			if(id_token.symbol == this->tree.get_token(var_decl_node.id).symbol){
+				this->report(Code::self_declaration, id_token);
+				return;
+			}
+		}
 
-				}else if(var_decl->value->get_type() == AST::ExprType::Id){
-					auto id_token = static_cast<AST::Id*>(var_decl->value)->token;
+		auto value_type = this->get_expr_type(var_decl_node.value);
+		if(this->blocked_on != Declarations::none){ return; }
 
-					if(id_token.value == var_name){
-						this->error(id_token);
-						cmd::error("\tCannot set variable to self in a declaration");
-						return;
-					}
+		this->check_var_decl_type(var_decl, value_type);
+	};
 
-					var_decl->type = this->get_expr_type(var_decl->value);
 
+	bool SemanticAnalyzer::func_checking(AST::Index<AST::FuncDef> func_def){
+		this->enter_scope();
 
-				}else if(var_decl->value->get_type() == AST::ExprType::FuncCall){
-					auto* func_call = static_cast<AST::FuncCall*>(var_decl->value);
-					auto func_call_name = func_call->id->token.value;
+		auto& func_def_node = this->tree.get(func_def);
+		auto func_def_id = this->tree.get_token(func_def_node.id);
 
-					this->func_call_type_inference(func_call);
+		for(uint32_t i = 0; i < func_def_node.params.size; i++){
+			auto param = func_def_node.params.index(i);
+			auto param_id = this->tree.get_token(this->tree.get(param).id);
+			auto param_name = param_id.symbol;
 
-					var_decl->type = this->functions[func_call_name]->return_type;
+			if(auto first_decl = this->in_current_scope(param_name); !first_decl.is_none()){
+				auto first_definition = this->tree.get_token(this->tree.get(first_decl).id);
+				this->report(Code::param_redefined, param_id, {first_definition.value, Location(first_definition)});
+				this->leave_scope();
+				return false;
+			}
 
+			if(auto first_decl = this->in_scope(param_name); !first_decl.is_none()){
+				auto first_definition = this->tree.get_token(this->tree.get(first_decl).id);
+				this->report(Code::param_shadows, param_id, {first_definition.value, Location(first_definition)});
+			}
 
-				}else{
-					cmd::fatal("Compiler Fail: Received unknown expr type (SemanticAnalyzer, line: {})", __LINE__);
-					this->error(var_decl->value);
-					return;
-				}
+			this->add_to_scope(param_name, param);
 
+		}
 
+		for(auto stmt : this->tree.get(this->tree.get(func_def_node.block).stmts)){
+			this->func_checking_type_inference_attempt_impl(func_def, stmt);
+			if(this->blocked_on != Declarations::none){ break; }
+		}
 
-			} break;
+		if(this->blocked_on != Declarations::none){
+			this->leave_scope();
+			return true;
+		}
 
+		if(func_def_node.return_type_id == types::none){
+			if(this->found_return_stmt){
+				this->report(Code::return_in_void_function, func_def_id, {func_def_id.value});
+			}else{
+				func_def_node.return_type_id = types::type_void;
+			}
+		}else if(!this->found_return_stmt && func_def_node.return_type_id != types::type_void){
+			this->report(Code::missing_return, func_def_id, {func_def_id.value});
+		}
 
-			case AST::StmtType::VarAssign: break;
+		this->leave_scope();
+		return true;
+	};
 
-			//////////////////////////////////////////////////////////////////////
-			// FuncCallStmt
 
-			case AST::StmtType::FuncCallStmt: {
-				auto* func_call_stmt = static_cast<AST::FuncCallStmt*>(stmt);
-				auto* func_call = static_cast<AST::FuncCall*>(func_call_stmt->expr);
+	// walks the statement with an explicit stack, so deeply nested conditionals can't overflow the call stack
+	// 	children are pushed in reverse so they're visited in order, a none entry marks where a scope ends
+	void SemanticAnalyzer::func_checking_type_inference_attempt_impl(AST::Index<AST::FuncDef> func_def, AST::Stmt root){
+		auto& stack = this->stmt_stack;
+		stack.push_back(root);
 
-				this->func_call_type_inference(func_call);
+		while(!stack.empty()){
+			auto stmt = stack.back();
+			stack.pop_back();
 
-			} break;
+			if(stmt.is_none()){
+				this->leave_scope();
+				continue;
+			}
 
-			//////////////////////////////////////////////////////////////////////
-			// ReturnStmt
+			// a blocked check only leaves its scopes
+			if(this->blocked_on != Declarations::none){ continue; }
 
-			case AST::StmtType::ReturnStmt: {
-				auto return_stmt = static_cast<AST::ReturnStmt*>(stmt);
-				this->found_return_stmt = true;
 
-				auto return_type = this->get_expr_type(return_stmt->expr);
+			if(this->found_return_stmt && !this->printed_return_error){
+				this->report(Code::code_after_return, stmt);
+				this->printed_return_error = true;
+			}
 
-				if(func_def->return_type == nullptr){
-					func_def->return_type = return_type;
-				}else{
-					if(return_type == nullptr){
-						this->warning(return_stmt);
-						cmd::warning("\tUnable to determine type of return statement in function ({})", func_def->id->token.value);
-						return;
+			switch(stmt.get_type()){
+
+				//////////////////////////////////////////////////////////////////////
+				// VarDecl
+
+				case AST::StmtType::VarDecl: {
+					auto var_decl = AST::Index<AST::VarDecl>(stmt.index());
+					auto& var_decl_node = this->tree.get(var_decl);
+					auto var_decl_id = this->tree.get_token(var_decl_node.id);
+					auto var_name = var_decl_id.symbol;
+					if(auto first_decl = this->in_current_scope(var_name); !first_decl.is_none()){
+						auto first_definition = this->tree.get_token(this->tree.get(first_decl).id);
+						this->report(Code::var_redefined, var_decl_id, {first_definition.value, Location(first_definition)});
+						continue;
 					}
 
-					if(!this->same_expr_type(func_def->return_type, return_type)){
-						this->error(return_stmt);
-						cmd::error("\tUnmatching return types (func: {}, return: {})", func_def->return_type->token.value, return_type->token.value);
-						return;
+					if(auto first_decl = this->in_scope(var_name); !first_decl.is_none()){
+						auto first_definition = this->tree.get_token(this->tree.get(first_decl).id);
+						this->report(Code::var_shadows, var_decl_id, {first_definition.value, Location(first_definition)});
 					}
-				}
 
-			}break;
+					this->add_to_scope(var_name, var_decl);
+					if(var_decl_node.value.is_none()){ continue; }
 
-			//////////////////////////////////////////////////////////////////////
-			// FuncDef
 
-			case AST::StmtType::FuncDef: {
-				this->error(stmt);
-				cmd::error("\tFunction definitions must be in global scope");
-				cmd::error("\tThey must be outside all functions");
-				return;
-			} break;
+					if(var_decl_node.value.get_type() == AST::ExprType::Literal || var_decl_node.value.get_type() == AST::ExprType::Binary){
+						auto value_type = this->get_expr_type(var_decl_node.value);
+						if(this->blocked_on != Declarations::none){ continue; }
 
-			//////////////////////////////////////////////////////////////////////
-			// Conditional
+						this->check_var_decl_type(var_decl, value_type);
 
-			case AST::StmtType::Conditional: {
-				auto conditional = static_cast<AST::Conditional*>(stmt);
-				this->enter_scope();
-				for(auto* then_stmt : conditional->then_block->stmts){
-					func_checking_type_inference_attempt_impl(func_def, then_stmt);
-				}
-				this->leave_scope();
 
-				if(conditional->else_block != nullptr){
-					func_checking_type_inference_attempt_impl(func_def, conditional->else_block);
-				}
-			}break;
+					}else if(var_decl_node.value.get_type() == AST::ExprType::Id){
+						auto id_token = this->tree.get_token(var_decl_node.value);
 
-			//////////////////////////////////////////////////////////////////////
-			// Block
+						if(id_token.symbol == var_name){
+							this->report(Code::self_declaration, id_token);
+							continue;
+						}
 
-			case AST::StmtType::Block: {
-				this->enter_scope();
-				for(auto* block_stmt : static_cast<AST::Block*>(stmt)->stmts){
-					func_checking_type_inference_attempt_impl(func_def, block_stmt);
-				}
-				this->leave_scope();
-			} break;
+						auto value_type = this->get_expr_type(var_decl_node.value);
+						if(this->blocked_on != Declarations::none){ continue; }
 
-			//////////////////////////////////////////////////////////////////////
-			// default
+						this->check_var_decl_type(var_decl, value_type);
 
-			default: {
-				cmd::fatal("Compiler Fail: Received unknown statement type (SemanticAnalyzer, line: {})", __LINE__);
-				this->error(stmt);
-			}
-		};
-	};
 
+					}else if(var_decl_node.value.get_type() == AST::ExprType::FuncCall){
+						auto func_call = AST::Index<AST::FuncCall>(var_decl_node.value.index());
 
+						if(!this->func_call_type_inference(func_call)){ continue; }
 
+						auto func_call_id = this->tree.get_token(this->tree.get(func_call).id);
+						auto return_type = this->get_decl_type(this->find_decl(AST::Stmt(*this->functions.find(func_call_id.symbol))), func_call_id);
+						if(this->blocked_on != Declarations::none){ continue; }
 
+						this->check_var_decl_type(var_decl, return_type);
 
 
+					}else{
+						this->report(Code::unknown_expression, var_decl_node.value, {__LINE__});
+						continue;
+					}
 
-	void SemanticAnalyzer::func_call_type_inference(AST::FuncCall* func_call){
-		auto func_call_name = func_call->id->token.value;
 
-		if(func_call_name == "printf"){
-			return;
-		}
 
-		if(!this->functions.contains(func_call_name)){
-			this->error(func_call);
-			cmd::error("\tFunction ({}) is not defined", func_call_name);
-			return;
-		}
+				} break;
 
-		auto function = this->functions[func_call_name];
 
-		auto& call_args = func_call->params->params;
-		auto call_arg_count = call_args.size();
+				//////////////////////////////////////////////////////////////////////
+				// VarAssign
 
-		auto& func_args = function->params->params;
-		auto func_arg_count = func_args.size();
+				case AST::StmtType::VarAssign: {
+					auto& var_assign = this->tree.get<AST::VarAssign>(stmt);
+					auto var_assign_id = this->tree.get_token(var_assign.id);
+					auto var_name = var_assign_id.value;
 
+					auto var = this->in_scope(var_assign_id.symbol);
+					if(var.is_none()){
+						this->report(Code::assign_undefined_var, stmt, {var_name});
+						continue;
+					}
 
 
-		if(call_arg_count != func_arg_count){
-			this->error(func_call);
-			cmd::error("\tInvalid number of function call arguments");
-			cmd::error("\tFunction ({}) has ({}) arguments, recieved ({})", func_call_name, func_arg_count, call_arg_count);
-			return;
-		}
+					auto var_type = this->tree.get(var).type_id;
+					auto assign_type = this->get_expr_type(var_assign.value);
+					if(!this->same_expr_type(var_type, assign_type)){
+						this->report(Code::assign_type_mismatch, stmt, {var_name, this->types.print(var_type), this->types.print(assign_type)});
+					}
 
+				} break;
 
-		for(int i = 0; i < call_arg_count; i++){
-			if(!this->same_expr_type(
-				this->get_expr_type(call_args[i]),
-				func_args[i]->type
-			)){
+				//////////////////////////////////////////////////////////////////////
+				// FuncCallStmt
 
-				auto correct_type = func_args[i]->type->token.value;
-				auto recieved_type = this->get_expr_type(call_args[i])->token.value;
+				case AST::StmtType::FuncCallStmt: {
+					auto func_call = this->tree.get<AST::FuncCallStmt>(stmt).expr;
+					if(this->tree.get_token(this->tree.get(func_call).id).symbol == symbols::func_printf){
+						this->report(Code::printf_not_checked, nullptr);
+					}
 
-				this->error(func_call);
-				cmd::error("\tIncorrect function argument type in function ({})", func_call_name);
-				cmd::error("\tArgument ({}/{}) is ({}), recieved ({})", i + 1, func_arg_count, correct_type, recieved_type);
-				return;
+					this->func_call_type_inference(func_call);
 
-			}
-		}
+				} break;
+
+				//////////////////////////////////////////////////////////////////////
+				// ReturnStmt
+
+				case AST::StmtType::ReturnStmt: {
+					auto& return_stmt = this->tree.get<AST::ReturnStmt>(stmt);
+					auto& func_def_node = this->tree.get(func_def);
+					this->found_return_stmt = true;
+
+					auto return_type = this->get_expr_type(return_stmt.expr);
+
+					if(func_def_node.return_type_id == types::none){
+						func_def_node.return_type_id = return_type;
+					}else{
+						if(return_type == types::none){
+							this->report(Code::unknown_return_type, stmt, {this->tree.get_token(func_def_node.id).value});
+							continue;
+						}
+
+						if(!this->same_expr_type(func_def_node.return_type_id, return_type)){
+							this->report(Code::return_type_mismatch, stmt, {this->types.print(func_def_node.return_type_id), this->types.print(return_type)});
+							continue;
+						}
+					}
 
+				}break;
 
+				//////////////////////////////////////////////////////////////////////
+				// FuncDef
+
+				case AST::StmtType::FuncDef: {
+					this->report(Code::nested_function, stmt);
+					continue;
+				} break;
+
+				//////////////////////////////////////////////////////////////////////
+				// Conditional
+
+				case AST::StmtType::Conditional: {
+					auto& conditional = this->tree.get<AST::Conditional>(stmt);
+
+					if( !this->same_expr_type(types::type_bool, this->get_expr_type(conditional.cond)) ){
+						this->report(Code::condition_not_bool, conditional.cond);
+					}
+
+					if(!conditional.else_block.is_none()){
+						stack.push_back(conditional.else_block);
+					}
+
+					// the then block's scope is entered here, the Block itself isn't visited
+					this->enter_scope();
+					stack.push_back(AST::Stmt());
+					auto then_stmts = this->tree.get(this->tree.get(conditional.then_block).stmts);
+					stack.insert(stack.end(), then_stmts.rbegin(), then_stmts.rend());
+				}break;
+
+				//////////////////////////////////////////////////////////////////////
+				// Block
+
+				case AST::StmtType::Block: {
+					this->enter_scope();
+					stack.push_back(AST::Stmt());
+					auto block_stmts = this->tree.get(this->tree.get<AST::Block>(stmt).stmts);
+					stack.insert(stack.end(), block_stmts.rbegin(), block_stmts.rend());
+				} break;
+
+				//////////////////////////////////////////////////////////////////////
+				// default
+
+				default: {
+					this->report(Code::unknown_statement, stmt, {__LINE__});
+				}
+			};
+		};
 	};
 
 
@@ -410,332 +662,319 @@ namespace Hawk{
 
 
 
+	// false if the call has no return type to read (printf or an undefined function)
+	bool SemanticAnalyzer::func_call_type_inference(AST::Index<AST::FuncCall> func_call){
+		auto& func_call_node = this->tree.get(func_call);
+		auto func_call_id = this->tree.get_token(func_call_node.id);
+		auto func_call_name = func_call_id.value;
+		auto func_call_symbol = func_call_id.symbol;
 
-	void SemanticAnalyzer::final_check_all(){
-		// clear/reset scopes
-		this->scopes.clear();
-		this->enter_scope();
+		if(func_call_symbol == symbols::func_printf){
+			return false;
+		}
 
-		// iterate through all statements
-		for(auto* stmt : this->stmts){
-			this->final_check_all_impl(stmt);
+		auto* func_def = this->functions.find(func_call_symbol);
+		if(func_def == nullptr){
+			this->report(Code::undefined_function, func_call_id, {func_call_name});
+			return false;
 		}
-	};
 
-	void SemanticAnalyzer::final_check_all_impl(AST::Stmt* stmt){
-		switch(stmt->get_type()){
-			case AST::StmtType::Block: {
-				auto block_stmt = static_cast<AST::Block*>(stmt);
+		// the parameters are always written, only the return type can be pending
+		this->add_dependency(this->find_decl(AST::Stmt(*func_def)));
 
-				this->enter_scope();
-				for(auto* block_stmt : block_stmt->stmts){
-					this->final_check_all_impl(block_stmt);
-				}
-				this->leave_scope();
+		auto& function = this->tree.get(*func_def);
 
-			} break;case AST::StmtType::VarDecl: {
-				auto var_decl = static_cast<AST::VarDecl*>(stmt);
-				auto var_name = var_decl->id->token.value;
+		auto call_args = this->tree.get(func_call_node.params);
+		auto call_arg_count = call_args.size();
 
-				if(var_decl->type == nullptr){
-					// type not defined
-					var_decl->type = this->get_expr_type(var_decl->value);
-				}else{
-					// type is defined
-					auto expr_type = this->get_expr_type(var_decl->value);
+		auto func_args = this->tree.get(function.params);
+		auto func_arg_count = func_args.size();
 
 
 
-					if(!this->same_expr_type(var_decl->type, expr_type)){
-						this->error(var_decl);
-						cmd::error("\tType mismatch in definition of variable ({})", var_name);
-						cmd::error("\t{{ {} : ({}) = ({}) }}", var_name, var_decl->type->token.value, expr_type->token.value);
-						return;
-					}
-				}
+		if(call_arg_count != func_arg_count){
+			this->report(Code::wrong_arg_count, func_call_id, {func_call_name, func_arg_count, call_arg_count});
+			return true;
+		}
 
-				this->add_to_scope(var_name, var_decl);
 
-			} break;case AST::StmtType::VarAssign: {
-				auto var_assign = static_cast<AST::VarAssign*>(stmt);
-				auto var_name = var_assign->id->token.value;
+		for(int i = 0; i < call_arg_count; i++){
+			auto arg_type = this->get_expr_type(call_args[i]);
 
-				auto* var = this->in_scope(var_name);
-				if(var == nullptr){
-					this->error(var_assign);
-					cmd::error("\tAssignment of undefined variable ({})", var_name);
-				}
+			if(!this->same_expr_type(arg_type, func_args[i].type_id)){
+				auto correct_type = this->types.print(func_args[i].type_id);
+				auto recieved_type = this->types.print(arg_type);
 
+				this->report(Code::wrong_arg_type, func_call_id, {func_call_name, i + 1, func_arg_count, correct_type, recieved_type});
+				return true;
 
-				auto* var_type = var->type;
-				auto* assign_type = this->get_expr_type(var_assign->value);
-				if(!this->same_expr_type(var_type, assign_type)){
-					this->error(var_assign);
-					cmd::error("\tIncorrect expression type in assignment of variable ({})", var_name);
-					cmd::error("\texpected ({}), recieved ({})", var_type->token.value, assign_type->token.value);
-				}
+			}
+		}
 
-			} break;case AST::StmtType::FuncCallStmt: {
-				auto* func_call_stmt = static_cast<AST::FuncCallStmt*>(stmt);
-				if(func_call_stmt->expr->id->token.value == "printf"){
-					cmd::warning("Semantic Analyzer not run on arguments to printf (may cause compilation errors/seg-faults)");
-				}
+		return true;
+	};
 
-			} break;case AST::StmtType::ReturnStmt: {
-				// do nothing
-			// 	auto return_stmt = static_cast<AST::ReturnStmt*>(stmt);
 
-			} break;case AST::StmtType::FuncDef: {
-				auto func_def = static_cast<AST::FuncDef*>(stmt);
 
-				this->enter_scope();
 
-				for(auto* param : func_def->params->params){
-					auto param_name = param->id->token.value;
 
-					this->add_to_scope(param_name, new AST::VarDecl(param->id, param->type, nullptr));
 
-				}
 
-				this->final_check_all_impl(func_def->block);
 
-				this->leave_scope();
+	// a declaration without a written type gets the type of its value, a written one has to match it
+	void SemanticAnalyzer::check_var_decl_type(AST::Index<AST::VarDecl> var_decl, TypeId value_type){
+		auto& var_decl_node = this->tree.get(var_decl);
 
-			} break;case AST::StmtType::Conditional: {
-				auto conditional = static_cast<AST::Conditional*>(stmt);
+		if(var_decl_node.type_id == types::none){
+			var_decl_node.type_id = value_type;
+			return;
+		}
 
+		if(!this->same_expr_type(var_decl_node.type_id, value_type)){
+			auto var_name = this->tree.get_token(var_decl_node.id).value;
+			this->report(Code::var_decl_type_mismatch, AST::Stmt(var_decl), {var_name, var_name, this->types.print(var_decl_node.type_id), this->types.print(value_type)});
+		}
+	};
 
-				if( !this->same_expr_type(this->types["bool"], this->get_expr_type(conditional->cond)) ){
-					this->error(conditional->cond);
-					cmd::error("\tConditional expressions must return type 'bool'");
-				}
 
-				this->final_check_all_impl(conditional->then_block);
 
-				if(conditional->else_block != nullptr){
-					this->final_check_all_impl(conditional->else_block);					
-				}
+	//////////////////////////////////////////////////////////////////////
+	// declarations
 
-			} break;default: {
-				cmd::fatal("Compiler Fail: Received unknown statement type (SemanticAnalyzer, line: {})", __LINE__);
-				this->error(stmt);
-			}
-		};
+	uint32_t SemanticAnalyzer::find_decl(AST::Stmt decl) const {
+		if(decl.get_type() == AST::StmtType::VarDecl){
+			return this->declarations->by_var_decl[decl.index()];
+		}
+		return this->declarations->by_func_def[decl.index()];
 	};
 
 
+	void SemanticAnalyzer::add_dependency(uint32_t decl){
+		if(this->current_decl == Declarations::none || !this->declarations->keep_dependencies){ return; }
 
+		auto& dependencies = this->declarations->list[this->current_decl].dependencies;
+		if(dependencies.empty() || dependencies.back() != decl){
+			dependencies.push_back(decl);
+		}
+	};
+
+
+	// the type of a global or the return type of a function
+	// 	a pending one blocks the current check (blocked_on), it's checked first and the current check is done again
+	TypeId SemanticAnalyzer::get_decl_type(uint32_t decl, const Tokenizer::Token& used_at){
+		this->add_dependency(decl);
+
+		auto& declaration = this->declarations->list[decl];
+		auto type = declaration.stmt.get_type() == AST::StmtType::VarDecl
+			? this->tree.get<AST::VarDecl>(declaration.stmt).type_id
+			: this->tree.get<AST::FuncDef>(declaration.stmt).return_type_id;
+
+		if(type != types::none || this->blocked_on != Declarations::none){ return type; }
+
+		switch(declaration.state){
+			case Declarations::State::pending: {
+				this->blocked_on = decl;
+			} break;
+
+			case Declarations::State::in_progress: {
+				this->report(Code::type_cycle, used_at, {used_at.value});
+			} break;
+
+			case Declarations::State::checked: break;
+		};
+
+		return types::none;
+	};
 
 
 	//////////////////////////////////////////////////////////////////////
 	// expr helpers
 
 
-	AST::Type* SemanticAnalyzer::get_expr_type(AST::Expr* expr){
+	TypeId SemanticAnalyzer::get_expr_type(AST::Expr expr){
 
-		switch(expr->get_type()){
+		switch(expr.get_type()){
 			case AST::ExprType::Literal: {
-				std::string type_str;
-				switch(static_cast<AST::Literal*>(expr)->token.type){
-					break;case TokenType::literal_bool: type_str = "bool";
-					break;case TokenType::literal_int: type_str = "int";
-					break;case TokenType::literal_float: type_str = "float";
-					break;default:
-						this->error(expr);
-						cmd::fatal("\tUnknown literal type ({})", Parser::print_token(static_cast<AST::Literal*>(expr)->token.type));
+				auto literal = this->tree.get_token(expr);
+				switch(literal.type){
+					case TokenType::literal_bool: return types::type_bool;
+					case TokenType::literal_int: return types::type_int;
+					case TokenType::literal_float: return types::type_float;
+					default:
+						this->report(Code::unknown_literal, expr, {literal.value});
+						return types::none;
 				};
 
-				// auto new_token = Tokenizer::Token(TokenType::generated);
-				// new_token.value = type_str;
-				// return new AST::Type(new_token);
-				return this->types[type_str];
-
 			} break; case AST::ExprType::Id: {
-				auto id_token = static_cast<AST::Id*>(expr)->token;
+				auto id_token = this->tree.get_token(expr);
 
-				if(!this->in_scope(id_token.value)){
-					this->error(id_token);
-					cmd::error("\tVariable ({}) is not defined", id_token.value);
-					return nullptr;	
+				auto value_id = this->in_scope(id_token.symbol);
+				if(value_id.is_none()){
+					this->report(Code::undefined_variable, id_token, {id_token.value});
+					return types::none;
 				}
 
-				auto value_id = this->in_scope(id_token.value);
-				if(value_id->type == nullptr){
-					this->error(id_token);
-					cmd::error("\tVariable ({}) doesn't have a type", id_token.value);
-					return nullptr;
-				};
-
-				return new AST::Type(value_id->type->token);
+				auto value_type = this->tree.get(value_id).type_id;
 
-			} break; case AST::ExprType::Type: {
-				this->error(expr);
-				cmd::fatal("\tCompiler Fail:\n\tReceived unexpected AST::Type (SemanticAnalyzer, line: {})", __LINE__);
-				return nullptr;
+				// a global without a type already has an error (its own, or the cycle it's in)
+				// 	a typed one only needs its declaration if the read is kept as a dependency
+				if(value_type == types::none || this->declarations->keep_dependencies){
+					if(auto decl = this->find_decl(AST::Stmt(value_id)); decl != Declarations::none){
+						return this->get_decl_type(decl, id_token);
+					}
+				}
 
-			} break; case AST::ExprType::Param: {
-				this->error(expr);
-				cmd::fatal("\tUNIMPLEMENTED\tAST::Param (SemanticAnalyzer, line: {})", __LINE__);
-				return nullptr;
+				if(value_type == types::none){
+					this->report(Code::untyped_variable, id_token, {id_token.value});
+					return types::none;
+				};
 
-			} break; case AST::ExprType::Params: {
-				this->error(expr);
-				cmd::fatal("\tUNIMPLEMENTED\tAST::Params (SemanticAnalyzer, line: {})", __LINE__);
-				return nullptr;
+				return value_type;
 
 			} break; case AST::ExprType::FuncCall: {
-				auto func_call = static_cast<AST::FuncCall*>(expr);
-				auto func_call_name = func_call->id->token.value;
+				auto func_call_id = this->tree.get_token(this->tree.get<AST::FuncCall>(expr).id);
+				auto func_call_name = func_call_id.value;
+
+				if(auto* function = this->functions.find(func_call_id.symbol); function != nullptr){
+					auto return_type = this->tree.get(*function).return_type_id;
+					if(return_type != types::none && !this->declarations->keep_dependencies){ return return_type; }
 
-				if(this->functions.contains(func_call_name)){
-					return this->functions[func_call_name]->return_type;
+					return this->get_decl_type(this->find_decl(AST::Stmt(*function)), func_call_id);
 				}else{
-					this->error(func_call);
-					cmd::error("\tFunction ({}) is not defined", func_call_name);
-					return nullptr;	
+					this->report(Code::undefined_function, func_call_id, {func_call_name});
+					return types::none;
 				}
 
 			} break; case AST::ExprType::Binary: {
-				auto binary = static_cast<AST::Binary*>(expr);
+				// operator chains nest as deep as they are long, so the operands are visited with an explicit stack
+				// 	a binary is pushed again (as visited) under its operands and typed once both operand types are on type_stack
+				size_t expr_start = this->expr_stack.size();
+				size_t type_start = this->type_stack.size();
 
+				this->expr_stack.emplace_back(expr, false);
 
-				auto left = this->get_expr_type(binary->left);
-				auto right = this->get_expr_type(binary->right);
+				while(this->expr_stack.size() > expr_start){
+					auto [current, visited] = this->expr_stack.back();
+					this->expr_stack.pop_back();
 
-				if(binary->type != nullptr){
-					return binary->type;
-				}
-				
-				if(left == nullptr) return nullptr;
-				if(right == nullptr) return nullptr;
-
-				if(!this->same_expr_type(left, right)){
-					this->error(binary->left);
-					cmd::error("\tBinary expression is invalid");
-					cmd::error("\t[ ({}) {} ({}) ]", left->token.value, binary->op.value, right->token.value);
-					return nullptr;
-				}
+					if(current.get_type() != AST::ExprType::Binary){
+						this->type_stack.push_back(this->get_expr_type(current));
 
+					}else if(!visited){
+						auto& binary = this->tree.get<AST::Binary>(current);
 
-				switch(binary->op.type){
-					case TokenType::op_plus:
-					case TokenType::op_minus:
-					case TokenType::op_mult:
-					case TokenType::op_div:{
-						binary->type = left;
-						return left;
-					}
+						// already typed, its operands aren't visited again
+						if(binary.type != types::none){
+							this->type_stack.push_back(binary.type);
+							continue;
+						}
+
+						this->expr_stack.emplace_back(current, true);
+						this->expr_stack.emplace_back(binary.right, false);
+						this->expr_stack.emplace_back(binary.left, false);
 
-					case TokenType::op_lt:
-					case TokenType::op_lte:
-					case TokenType::op_gt:
-					case TokenType::op_gte:
-					case TokenType::op_eq: 
-					case TokenType::op_neq:
-					case TokenType::op_and:
-					case TokenType::op_or: 
-					{
-						auto bool_token = Tokenizer::Token(TokenType::generated);
-						bool_token.value = "bool";
-						binary->type = new AST::Type(bool_token);
-						return new AST::Type(bool_token);
-					};
-
-					default: {
-						this->error(expr);
-						cmd::fatal("\tCompiler Fail:\n\tReceived unknown binary operation type (SemanticAnalyzer, line: {})", __LINE__);
-						return nullptr;
-					};
+					}else{
+						auto right = this->type_stack.back();
+						this->type_stack.pop_back();
+						auto& left = this->type_stack.back();
+
+						left = this->get_binary_type(current, left, right);
+					}
 				};
 
-				
-				
+				auto output = this->type_stack.back();
+				this->type_stack.resize(type_start);
+				return output;
+
 			} break; default: {
-				this->error(expr);
-				cmd::fatal("\tCompiler Fail:\n\tReceived unknown expression type (SemanticAnalyzer, line: {})", __LINE__);
-				return nullptr;
+				this->report(Code::unknown_expression, expr, {__LINE__});
+				return types::none;
 			}
 		};
 
 	};
 
 
-	bool SemanticAnalyzer::same_expr_type(AST::Type* type1, AST::Type* type2){
-		if(type1 == nullptr || type2 == nullptr){
-			return false;
-		}
+	// type of a binary expression from the types of its operands
+	TypeId SemanticAnalyzer::get_binary_type(AST::Expr expr, TypeId left, TypeId right){
+		auto& binary = this->tree.get<AST::Binary>(expr);
 
-		return type1->token.value == type2->token.value;
-	};
+		if(left == types::none) return types::none;
+		if(right == types::none) return types::none;
 
+		auto op = this->tree.get_token(binary.op);
 
+		if(!this->same_expr_type(left, right)){
+			this->report(Code::invalid_binary, binary.left, {this->types.print(left), op.value, this->types.print(right)});
+			return types::none;
+		}
 
-	//////////////////////////////////////////////////////////////////////
-	// error / warnings
 
+		switch(op.type){
+			case TokenType::op_plus:
+			case TokenType::op_minus:
+			case TokenType::op_mult:
+			case TokenType::op_div:{
+				binary.type = left;
+				return left;
+			}
+
+			case TokenType::op_lt:
+			case TokenType::op_lte:
+			case TokenType::op_gt:
+			case TokenType::op_gte:
+			case TokenType::op_eq: 
+			case TokenType::op_neq:
+			case TokenType::op_and:
+			case TokenType::op_or: 
+			{
+				binary.type = types::type_bool;
+				return binary.type;
+			};
 
-	void SemanticAnalyzer::error(const Tokenizer::Token& token){
-		cmd::error("\nERROR: <{}, {}>", token.line, token.collumn);
-		this->error_count += 1;
+			default: {
+				this->report(Code::unknown_binary_op, expr, {__LINE__});
+				return types::none;
+			};
+		};
 	};
 
 
+	bool SemanticAnalyzer::same_expr_type(TypeId type1, TypeId type2){
+		if(type1 == types::none || type2 == types::none){
+			return false;
+		}
 
-	void SemanticAnalyzer::error(AST::Expr* expr){
-		switch(expr->get_type()){
-			break; case AST::ExprType::Id:  	 this->error(static_cast<AST::Id*>(expr)->token);
-			break; case AST::ExprType::Type:     this->error(static_cast<AST::Type*>(expr)->token);
-			break; case AST::ExprType::Literal:  this->error(static_cast<AST::Literal*>(expr)->token);
-			break; case AST::ExprType::Param:	 this->error(static_cast<AST::Param*>(expr)->expr);
-			break; case AST::ExprType::Params:	 this->error(static_cast<AST::Params*>(expr)->start);
-			break; case AST::ExprType::FuncCall: this->error(static_cast<AST::FuncCall*>(expr)->id);
-			break; case AST::ExprType::Binary:   this->error(static_cast<AST::Binary*>(expr)->left);
-		};
+		return type1 == type2;
 	};
 
 
-	void SemanticAnalyzer::error(AST::Stmt* stmt){
-		switch(stmt->get_type()){
-			break; case AST::StmtType::Block:  	  	 this->error(static_cast<AST::Block*>(stmt)->start);
-			break; case AST::StmtType::VarDecl:      this->error(static_cast<AST::VarDecl*>(stmt)->id);
-			break; case AST::StmtType::VarAssign: 	 this->error(static_cast<AST::VarAssign*>(stmt)->id);
-			break; case AST::StmtType::FuncCallStmt: this->error(static_cast<AST::FuncCallStmt*>(stmt)->expr);
-			break; case AST::StmtType::ReturnStmt: 	 this->error(static_cast<AST::ReturnStmt*>(stmt)->expr);
-			break; case AST::StmtType::FuncDef: 	 this->error(static_cast<AST::FuncDef*>(stmt)->id);
-			break; case AST::StmtType::Conditional:  this->error(static_cast<AST::Conditional*>(stmt)->cond);
-		};
-	};
 
+	//////////////////////////////////////////////////////////////////////
+	// error / warnings
 
-	void SemanticAnalyzer::warning(const Tokenizer::Token& token){
-		cmd::warning("\nWARNING: <{}, {}>", token.line, token.collumn);
-		this->warning_count += 1;
-	};
+	void SemanticAnalyzer::report(Code code, const Tokenizer::Token* token, std::initializer_list<Diagnostics::Argument> arguments){
+		auto diagnostic = Diagnostics::make(code, token, arguments);
 
+		if(this->current_diagnostics != nullptr){
+			this->current_diagnostics->push_back(diagnostic);
+		}else{
+			this->diagnostics.report(diagnostic);
+		}
+	};
 
+	void SemanticAnalyzer::report(Code code, const Tokenizer::Token& token, std::initializer_list<Diagnostics::Argument> arguments){
+		this->report(code, &token, arguments);
+	};
 
-	void SemanticAnalyzer::warning(AST::Expr* expr){
-		switch(expr->get_type()){
-			break; case AST::ExprType::Id:  	 this->warning(static_cast<AST::Id*>(expr)->token);
-			break; case AST::ExprType::Type:     this->warning(static_cast<AST::Type*>(expr)->token);
-			break; case AST::ExprType::Literal:  this->warning(static_cast<AST::Literal*>(expr)->token);
-			break; case AST::ExprType::Param:	 this->warning(static_cast<AST::Param*>(expr)->expr);
-			break; case AST::ExprType::Params:	 this->warning(static_cast<AST::Params*>(expr)->start);
-			break; case AST::ExprType::FuncCall: this->warning(static_cast<AST::FuncCall*>(expr)->id);
-			break; case AST::ExprType::Binary:   this->warning(static_cast<AST::Binary*>(expr)->left);
-		};
+	void SemanticAnalyzer::report(Code code, AST::Expr expr, std::initializer_list<Diagnostics::Argument> arguments){
+		auto token = this->tree.get_token(expr);
+		this->report(code, &token, arguments);
 	};
 
-	void SemanticAnalyzer::warning(AST::Stmt* stmt){
-		switch(stmt->get_type()){
-			break; case AST::StmtType::Block:  	  	 this->warning(static_cast<AST::Block*>(stmt)->start);
-			break; case AST::StmtType::VarDecl:      this->warning(static_cast<AST::VarDecl*>(stmt)->id);
-			break; case AST::StmtType::VarAssign: 	 this->warning(static_cast<AST::VarAssign*>(stmt)->id);
-			break; case AST::StmtType::FuncCallStmt: this->warning(static_cast<AST::FuncCallStmt*>(stmt)->expr);
-			break; case AST::StmtType::ReturnStmt: 	 this->warning(static_cast<AST::ReturnStmt*>(stmt)->expr);
-			break; case AST::StmtType::FuncDef: 	 this->warning(static_cast<AST::FuncDef*>(stmt)->id);
-			break; case AST::StmtType::Conditional:  this->warning(static_cast<AST::Conditional*>(stmt)->cond);
-		};
+	void SemanticAnalyzer::report(Code code, AST::Stmt stmt, std::initializer_list<Diagnostics::Argument> arguments){
+		auto token = this->tree.get_token(stmt);
+		this->report(code, &token, arguments);
 	};
 
 
@@ -744,42 +983,36 @@ namespace Hawk{
 	// scoping
 
 	void SemanticAnalyzer::enter_scope(){
-		this->scopes.emplace_back();
+		this->scopes.enter_scope();
 	};
 
 	void SemanticAnalyzer::leave_scope(){
-		this->scopes.pop_back();
+		this->scopes.leave_scope();
 		this->found_return_stmt = false;
 		this->printed_return_error = false;
 	};
 
-	void SemanticAnalyzer::add_to_scope(std::string var_name, AST::VarDecl* var_decl){
-		this->scopes.back()[var_name] = var_decl;
+	void SemanticAnalyzer::add_to_scope(SymbolId var_name, AST::Index<AST::VarDecl> var_decl){
+		this->scopes.add(var_name, var_decl);
 	};
 
-	AST::VarDecl* SemanticAnalyzer::in_scope(const std::string& var_name){
-
-
-		for(std::list<Scope>::reverse_iterator ptr = this->scopes.rbegin(); ptr != this->scopes.rend(); ptr++){
-			auto scope = *ptr;
-			if(scope.contains(var_name)){
-				return scope[var_name];
-			}
+	AST::Index<AST::VarDecl> SemanticAnalyzer::in_scope(SymbolId var_name){
+		if(auto* var_decl = this->scopes.find(var_name); var_decl != nullptr){
+			return *var_decl;
 		}
-
-		return nullptr;
+		return {};
 	};
 
-	AST::VarDecl* SemanticAnalyzer::in_current_scope(const std::string& var_name){
-		if(this->scopes.back().contains(var_name)){
-			return this->scopes.back()[var_name];
+	AST::Index<AST::VarDecl> SemanticAnalyzer::in_current_scope(SymbolId var_name){
+		if(auto* var_decl = this->scopes.find_in_current_scope(var_name); var_decl != nullptr){
+			return *var_decl;
 		}
-		return nullptr;
+		return {};
 	};
 
 
 	bool SemanticAnalyzer::in_global_scope(){
-		return this->scopes.size() == 1;
+		return this->scopes.depth() == 1;
 	};
 
 
@@ -1,72 +1,158 @@
 #pragma once
 
 #include "Parser.h"
+#include "CharacterStream.h"
+#include "Diagnostics.h"
+#include "ConstEvaluator.h"
 
 namespace Hawk{
 
+	// what an error free analysis found out about the globals and functions, kept by the compile server for the next compile
+	// 	a function whose return type isn't written keeps the one it had if neither it nor anything its check read (directly or not) changed
+	// 	declarations are matched by name (SymbolIds of the shared interner) and by a hash of the source of their statement
+	struct Signatures{
+		struct Decl{
+			SymbolId name;
+			bool is_function;
+			size_t source_hash;
+			SymbolId return_type = symbols::none; // name of the inferred return type (none if it's written, and for globals)
+			std::vector<uint32_t> dependencies{};
+		};
+
+		std::vector<Decl> decls{};
+	};
+
+
+
 	class SemanticAnalyzer{
 		public:
-			SemanticAnalyzer(const std::vector<AST::Stmt*>& stmts);
-			~SemanticAnalyzer();
+			// the types it finds are set in the nodes of `ast`, the errors and warnings it finds go to `diagnostics`
+			// 	function bodies are checked on up to `thread_count` threads
+			SemanticAnalyzer(AST::Tree& ast, const SourceFiles& source_files, Diagnostics& diagnostics, uint thread_count = 1);
+			~SemanticAnalyzer() = default;
 
 			void begin();
 
-			inline uint get_error_count() const { return this->error_count; };
-			inline uint get_warning_count() const { return this->warning_count; };
+			inline uint get_error_count() const { return this->diagnostics.get_error_count(); };
+			inline uint get_warning_count() const { return this->diagnostics.get_warning_count(); };
+
+			// for the compile server, before begin()
+			// 	`statement_hashes` has a hash of the source of every top level statement (same order as tree.statements)
+			// 	the return types still right in `signatures` are used, and if the program is error free they're replaced by the ones of this compile
+			inline void use_signatures(Signatures& signatures, std::span<const size_t> statement_hashes){
+				this->signatures = &signatures;
+				this->statement_hashes = statement_hashes;
+			};
+
+			inline uint get_kept_return_types() const { return this->kept_return_types; };
 
 		private:
+			void resolve_written_types();
 			void get_all_globals();
-			void global_var_type_inference_attempt();
-			void func_checking_type_inference_attempt();
-			void func_checking_type_inference_attempt_impl(AST::FuncDef* func_def, AST::Stmt* stmt);
-			void func_call_type_inference(AST::FuncCall* func_call);
+			void check_declarations();
+			void check_global_values();
+			void keep_return_types(const std::vector<size_t>& decl_hashes);
+			void save_signatures(const std::vector<size_t>& decl_hashes);
+			bool check_decl(uint32_t decl);
+			void global_var_checking(AST::Index<AST::VarDecl> var_decl);
+			bool func_checking(AST::Index<AST::FuncDef> func_def);
+			void func_checking_type_inference_attempt_impl(AST::Index<AST::FuncDef> func_def, AST::Stmt stmt);
+			bool func_call_type_inference(AST::Index<AST::FuncCall> func_call);
 
-			void final_check_all();
-			void final_check_all_impl(AST::Stmt* stmt);
+			void check_var_decl_type(AST::Index<AST::VarDecl> var_decl, TypeId value_type);
 
+			uint32_t find_decl(AST::Stmt decl) const;
+			void add_dependency(uint32_t decl);
+			TypeId get_decl_type(uint32_t decl, const Tokenizer::Token& used_at);
 
-			AST::Type* get_expr_type(AST::Expr* expr);
-			bool same_expr_type(AST::Type* type1, AST::Type* type2);
 
+			TypeId get_expr_type(AST::Expr expr);
+			TypeId get_binary_type(AST::Expr expr, TypeId left, TypeId right);
+			bool same_expr_type(TypeId type1, TypeId type2);
 
-			void error(const Tokenizer::Token& token);
-			void error(AST::Expr* expr);
-			void error(AST::Stmt* stmt);
 
-			void warning(const Tokenizer::Token& token);
-			void warning(AST::Expr* expr);
-			void warning(AST::Stmt* stmt);
+			// `token` can be nullptr for a diagnostic without a location
+			void report(Diagnostics::Code code, const Tokenizer::Token* token, std::initializer_list<Diagnostics::Argument> arguments = {});
+			void report(Diagnostics::Code code, const Tokenizer::Token& token, std::initializer_list<Diagnostics::Argument> arguments = {});
+			void report(Diagnostics::Code code, AST::Expr expr, std::initializer_list<Diagnostics::Argument> arguments = {});
+			void report(Diagnostics::Code code, AST::Stmt stmt, std::initializer_list<Diagnostics::Argument> arguments = {});
 
 			void enter_scope();
 			void leave_scope();
-			void add_to_scope(std::string var_name, AST::VarDecl* var_decl);
-			AST::VarDecl* in_scope(const std::string& var_name);
-			AST::VarDecl* in_current_scope(const std::string& var_name);
+			void add_to_scope(SymbolId var_name, AST::Index<AST::VarDecl> var_decl);
+			AST::Index<AST::VarDecl> in_scope(SymbolId var_name);
+			AST::Index<AST::VarDecl> in_current_scope(SymbolId var_name);
 			bool in_global_scope();
 
 
 
+			// every global and function, in source order (globals first)
+			// 	a type that isn't written is inferred the first time it's needed, so declarations can be used before they're declared
+			struct Declarations{
+				static constexpr uint32_t none = ~uint32_t(0);
+
+				enum class State : uint8_t {
+					pending,     // type not inferred yet
+					in_progress, // being checked (reading its type now is a cycle, unless a return statement already set it)
+					checked,
+				};
+
+				struct Decl{
+					AST::Stmt stmt;
+					State state;
+
+					// reported in order once every declaration is checked
+					std::vector<Diagnostics::Diagnostic> diagnostics{};
+					bool stop = false; // the declarations after it aren't reported
+
+					// the declarations its check read the type (or parameters) of, can have repeats (only with keep_dependencies)
+					std::vector<uint32_t> dependencies{};
+				};
+
+				std::vector<Decl> list{};
+				std::vector<uint32_t> by_var_decl{}; // none for local variables
+				std::vector<uint32_t> by_func_def{};
+
+				bool keep_dependencies = false; // only the compile server reads them (for the next compile)
+			};
+
+
 		public:
-			std::map<std::string, AST::VarDecl*> global_vars;
-			std::map<std::string, AST::FuncDef*> functions;
+			symbols::Map<AST::Index<AST::VarDecl>> global_vars;
+			symbols::Map<AST::Index<AST::FuncDef>> functions;
+			types::Table types;
+			ConstEvaluator const_evaluator; // calls to pure functions with constant arguments, folded once the program is checked
 	
 		private:
-			const std::vector<AST::Stmt*>& stmts;
-			uint error_count = 0;
-			uint warning_count = 0;
+			AST::Tree& tree;
+			const SourceFiles& files;
+			Diagnostics& diagnostics;
+			uint thread_count;
 
 			bool found_return_stmt = false;
 			bool printed_return_error = false;
 
+			Signatures* signatures = nullptr;
+			std::span<const size_t> statement_hashes{};
+			uint kept_return_types = 0;
+
 
-			using Scope = std::map<std::string, AST::VarDecl*>;
-			std::list<Scope> scopes;
+			symbols::ScopedMap<AST::Index<AST::VarDecl>> scopes;
 
+			// shared with the worker analyzers
+			std::shared_ptr<Declarations> declarations = std::make_shared<Declarations>();
+			uint32_t current_decl = Declarations::none;
+			std::vector<Diagnostics::Diagnostic>* current_diagnostics = nullptr; // of the current declaration
 
+			// the pending declaration the current check needs the type of
+			// 	the check is dropped (its output too) and done again once that declaration is checked
+			uint32_t blocked_on = Declarations::none;
 
-			// these are generated (for equality testing)
-			std::map<std::string, AST::Type*> types;
 
+			// explicit stacks of the AST walks (kept to reuse their memory)
+			std::vector<AST::Stmt> stmt_stack;
+			std::vector<std::pair<AST::Expr, bool>> expr_stack;
+			std::vector<TypeId> type_stack;
 	};
 	
 }
@@ -8,371 +8,821 @@
 
 
 namespace Hawk{
-	
 
-	void Tokenizer::start(){
-		
-		while(!this->stream.end() && this->success()){
-			auto next_char = this->stream.next();
-			if(next_char.has_value()){
-
-				this->character = next_char.value();
-				if(this->character != '\0'){
-					this->process_char();
-				}else{
-					// cmd::print("EOF");
-					break;
-				}
+	//////////////////////////////////////////////////////////////////////
+	// lexer tables
+
+	namespace{
+
+		enum class CharClass : uint8_t {
+			other,
+			whitespace,
+			newline,
+			letter, // includes '_'
+			digit,
+			nul,
+
+			dot,
+			slash,
+			star,
+			plus,
+			minus,
+			lt,
+			gt,
+			eq,
+			bang,
+			amp,
+			pipe,
+			colon,
+			at,
+
+			semicolon,
+			comma,
+			open_paren,
+			close_paren,
+			open_brace,
+			close_brace,
+
+			_count,
+		};
 
-			}else{
-				cmd::fatal("Attempted to read past the end of the file");
-				this->error();
-			}
+
+		enum class State : uint8_t {
+			start,
+			done, // no transition, accept the current state
+
+			// runs, skipped through in bulk by the simd::Scanner (see Tokenizer::start)
+			whitespace,
+			id,
+			number,
+			number_fraction,
+			line_comment,
+			block_comment,
+
+			slash,
+			block_comment_star,
+			block_comment_slash,
+			block_comment_end,
+			comment_eof,         // '\0' inside of a comment
+
+			lt,
+			lt_eq,
+			gt,
+			gt_eq,
+			eq,
+			eq_eq,
+			bang,
+			bang_eq,
+			amp,
+			amp_amp,
+			pipe,
+			pipe_pipe,
+
+			colon,
+			at,
+			plus,
+			minus,
+			star,
+
+			semicolon,
+			comma,
+			open_paren,
+			close_paren,
+			open_brace,
+			close_brace,
+
+			unknown, // char that can't begin a token
+			eof,     // '\0' outside of a comment
+
+			// these states are never stayed in, entering them runs an action (see Tokenizer::start)
+			block_comment_open,  // "/*", depth += 1
+			block_comment_close, // "*/", depth -= 1
+
+			_count,
 		};
 
-	};
 
+		constexpr auto char_classes = [](){
+			auto classes = std::array<CharClass, 256>{};
+			classes.fill(CharClass::other);
+
+			for(auto c = 'a'; c <= 'z'; c++){ classes[c] = CharClass::letter; }
+			for(auto c = 'A'; c <= 'Z'; c++){ classes[c] = CharClass::letter; }
+			for(auto c = '0'; c <= '9'; c++){ classes[c] = CharClass::digit; }
+			classes['_'] = CharClass::letter;
+
+			classes[' ']  = CharClass::whitespace;
+			classes['\t'] = CharClass::whitespace;
+			classes['\r'] = CharClass::whitespace;
+			classes['\n'] = CharClass::newline;
+			classes['\0'] = CharClass::nul;
+
+			classes['.'] = CharClass::dot;
+			classes['/'] = CharClass::slash;
+			classes['*'] = CharClass::star;
+			classes['+'] = CharClass::plus;
+			classes['-'] = CharClass::minus;
+			classes['<'] = CharClass::lt;
+			classes['>'] = CharClass::gt;
+			classes['='] = CharClass::eq;
+			classes['!'] = CharClass::bang;
+			classes['&'] = CharClass::amp;
+			classes['|'] = CharClass::pipe;
+			classes[':'] = CharClass::colon;
+			classes['@'] = CharClass::at;
+
+			classes[';'] = CharClass::semicolon;
+			classes[','] = CharClass::comma;
+			classes['('] = CharClass::open_paren;
+			classes[')'] = CharClass::close_paren;
+			classes['{'] = CharClass::open_brace;
+			classes['}'] = CharClass::close_brace;
+
+			return classes;
+		}();
+
+
+		using TransitionTable = std::array<std::array<State, size_t(CharClass::_count)>, size_t(State::_count)>;
+
+		constexpr auto class_transitions = [](){
+			auto table = TransitionTable{};
+			for(auto& row : table){
+				row.fill(State::done);
+			}
 
-	void Tokenizer::error(){
-		this->has_errored = true;
-		cmd::error("\tline:    {}"
-			     "\n\tcollumn: {}", this->stream.get_line(), this->stream.get_collumn());
-	};
+			auto set = [&](State from, CharClass on, State to){
+				table[size_t(from)][size_t(on)] = to;
+			};
+
+			// every state that consumes "anything but" uses this
+			auto set_all = [&](State from, State to){
+				for(size_t i = 0; i < size_t(CharClass::_count); i++){
+					table[size_t(from)][i] = to;
+				}
+			};
+
+
+			// start
+			set_all(State::start, State::unknown);
+			set(State::start, CharClass::whitespace,  State::whitespace);
+			set(State::start, CharClass::newline,     State::whitespace);
+			set(State::start, CharClass::letter,      State::id);
+			set(State::start, CharClass::digit,       State::number);
+			set(State::start, CharClass::nul,         State::eof);
+			set(State::start, CharClass::slash,       State::slash);
+			set(State::start, CharClass::star,        State::star);
+			set(State::start, CharClass::plus,        State::plus);
+			set(State::start, CharClass::minus,       State::minus);
+			set(State::start, CharClass::lt,          State::lt);
+			set(State::start, CharClass::gt,          State::gt);
+			set(State::start, CharClass::eq,          State::eq);
+			set(State::start, CharClass::bang,        State::bang);
+			set(State::start, CharClass::amp,         State::amp);
+			set(State::start, CharClass::pipe,        State::pipe);
+			set(State::start, CharClass::colon,       State::colon);
+			set(State::start, CharClass::at,          State::at);
+			set(State::start, CharClass::semicolon,   State::semicolon);
+			set(State::start, CharClass::comma,       State::comma);
+			set(State::start, CharClass::open_paren,  State::open_paren);
+			set(State::start, CharClass::close_paren, State::close_paren);
+			set(State::start, CharClass::open_brace,  State::open_brace);
+			set(State::start, CharClass::close_brace, State::close_brace);
+
+			// runs
+			set(State::whitespace, CharClass::whitespace, State::whitespace);
+			set(State::whitespace, CharClass::newline,    State::whitespace);
+
+			set(State::id, CharClass::letter, State::id);
+			set(State::id, CharClass::digit,  State::id);
+
+			set(State::number, CharClass::digit, State::number);
+			set(State::number, CharClass::dot,   State::number_fraction);
+			set(State::number_fraction, CharClass::digit, State::number_fraction);
+
+			// comments
+			set(State::slash, CharClass::slash, State::line_comment);
+			set(State::slash, CharClass::star,  State::block_comment_open);
+
+			// the newline itself is left for the whitespace state
+			set_all(State::line_comment, State::line_comment);
+			set(State::line_comment, CharClass::newline, State::done);
+			set(State::line_comment, CharClass::nul,     State::comment_eof);
+
+			set_all(State::block_comment, State::block_comment);
+			set(State::block_comment, CharClass::star,  State::block_comment_star);
+			set(State::block_comment, CharClass::slash, State::block_comment_slash);
+			set(State::block_comment, CharClass::nul,   State::comment_eof);
+
+			set_all(State::block_comment_star, State::block_comment);
+			set(State::block_comment_star, CharClass::star,  State::block_comment_star);
+			set(State::block_comment_star, CharClass::slash, State::block_comment_close);
+			set(State::block_comment_star, CharClass::nul,   State::comment_eof);
+
+			set_all(State::block_comment_slash, State::block_comment);
+			set(State::block_comment_slash, CharClass::slash, State::block_comment_slash);
+			set(State::block_comment_slash, CharClass::star,  State::block_comment_open);
+			set(State::block_comment_slash, CharClass::nul,   State::comment_eof);
+
+			// operators
+			set(State::lt,   CharClass::eq,   State::lt_eq);
+			set(State::gt,   CharClass::eq,   State::gt_eq);
+			set(State::eq,   CharClass::eq,   State::eq_eq);
+			set(State::bang, CharClass::eq,   State::bang_eq);
+			set(State::amp,  CharClass::amp,  State::amp_amp);
+			set(State::pipe, CharClass::pipe, State::pipe_pipe);
+
+			return table;
+		}();
+
+
+		// the class transitions expanded to every byte, so running the DFA is a single lookup per char
+		constexpr auto transitions = [](){
+			auto table = std::array<std::array<State, 256>, size_t(State::_count)>{};
+
+			for(size_t state = 0; state < size_t(State::_count); state++){
+				for(size_t c = 0; c < 256; c++){
+					table[state][c] = class_transitions[state][size_t(char_classes[c])];
+				}
+			}
 
+			return table;
+		}();
 
 
+		// states not listed here don't produce a token (see Tokenizer::start)
+		constexpr auto accepts = [](){
+			auto table = std::array<TokenType, size_t(State::_count)>{};
+			table.fill(TokenType::none);
 
-	void Tokenizer::make_token(Token::Type type){
-		this->tokens.emplace_back(type, this->stream.get_line(), this->stream.get_collumn(), this->token_val);
-	};
+			table[size_t(State::number)]          = TokenType::literal_int;
+			table[size_t(State::number_fraction)] = TokenType::literal_float;
 
+			table[size_t(State::slash)]     = TokenType::op_div;
+			table[size_t(State::star)]      = TokenType::op_mult;
+			table[size_t(State::plus)]      = TokenType::op_plus;
+			table[size_t(State::minus)]     = TokenType::op_minus;
+			table[size_t(State::lt)]        = TokenType::op_lt;
+			table[size_t(State::lt_eq)]     = TokenType::op_lte;
+			table[size_t(State::gt)]        = TokenType::op_gt;
+			table[size_t(State::gt_eq)]     = TokenType::op_gte;
+			table[size_t(State::eq)]        = TokenType::assign;
+			table[size_t(State::eq_eq)]     = TokenType::op_eq;
+			table[size_t(State::bang_eq)]   = TokenType::op_neq;
+			table[size_t(State::amp_amp)]   = TokenType::op_and;
+			table[size_t(State::pipe_pipe)] = TokenType::op_or;
+			table[size_t(State::colon)]     = TokenType::type_def;
+			table[size_t(State::at)]        = TokenType::const_type_def;
 
-	void Tokenizer::process_char(){
-
-		this->token_val += this->character;
-		
-		if(
-			!this->is_whitespace() &&
-			!this->process_comments() &&
-			!this->process_id() &&
-			!this->process_number() &&
-			!this->process_operators() &&
-			!this->process_punctuation() &&
-			true
-		){
-			cmd::error("Unable to process char [{}] (charcode: {})", this->character, (uint)this->character);
-			this->error();
-		}
+			table[size_t(State::semicolon)]   = TokenType::semicolon;
+			table[size_t(State::comma)]       = TokenType::comma;
+			table[size_t(State::open_paren)]  = TokenType::open_paren;
+			table[size_t(State::close_paren)] = TokenType::close_paren;
+			table[size_t(State::open_brace)]  = TokenType::open_brace;
+			table[size_t(State::close_brace)] = TokenType::close_brace;
 
-		this->token_val = "";
+			return table;
+		}();
 
-	};
 
 
+		//////////////////////////////////////////////////////////////////////
+		// keyword hash
 
+		// first char, last char and length are enough to tell every keyword apart,
+		// 	so the seed of a multiplicative hash over them is searched for at compile time
+		constexpr uint keyword_hash_bits = std::bit_width(keywords.size()) + 1;
+		constexpr uint keyword_hash_size = 1u << keyword_hash_bits;
 
+		constexpr uint keyword_hash(std::string_view value, uint32_t seed){
+			auto key = uint32_t(uint8_t(value.front()))
+				| (uint32_t(uint8_t(value.back())) << 8)
+				| (uint32_t(value.size()) << 16);
 
-	bool Tokenizer::process_comments(){
-		if(this->character == '/'){
+			return uint((key * seed) >> (32 - keyword_hash_bits));
+		};
 
-			if(this->stream.peek(0) == '/'){
-				this->stream.move(1);
-				this->move_while_newline();
-				return true;
 
-			}else if(this->stream.peek(0) == '*'){
-				uint depth = 1;
-				this->stream.move(1);
-				this->move_while([&](){
-					if(this->character == '*' && this->stream.peek(0) == '/'){
-						depth -= 1;
-						this->stream.move(1);
-					}else if(this->character == '/' && this->stream.peek(0) == '*'){
-						depth += 1;
-						this->stream.move(1);
+		constexpr uint32_t keyword_seed = [](){
+			// start from the golden ratio so the products reach the top bits
+			for(uint32_t seed = 0x9E3779B1; seed < 0x9E3779B1 + 100'000; seed += 2){
+				auto used = std::array<bool, keyword_hash_size>{};
+				bool collided = false;
+
+				for(const auto& keyword : keywords){
+					auto slot = keyword_hash(keyword.name, seed);
+					if(used[slot]){
+						collided = true;
+						break;
 					}
+					used[slot] = true;
+				}
 
-					return depth > 0;
-				});
-				// this->stream.move(2);
-				return true;
+				if(!collided){ return seed; }
 			}
 
-		}
-		return false;
+			return uint32_t(0);
+		}();
+
+		static_assert(keyword_seed != 0, "no perfect hash found for the keywords (increase keyword_hash_bits)");
+
+
+		constexpr uint8_t no_keyword = 0xFF;
+		static_assert(keywords.size() < no_keyword);
+
+		constexpr auto keyword_slots = [](){
+			auto table = std::array<uint8_t, keyword_hash_size>{};
+			table.fill(no_keyword);
+
+			for(uint i = 0; i < keywords.size(); i++){
+				table[keyword_hash(keywords[i].name, keyword_seed)] = uint8_t(i);
+			}
+
+			return table;
+		}();
+
+	}
+
+
+
+	//////////////////////////////////////////////////////////////////////
+	// tokenizer
+
+	Tokenizer::Tokenizer(CharacterStream& char_stream)
+		: Tokenizer(char_stream, symbols::get_interner()) {};
+
+	Tokenizer::Tokenizer(CharacterStream& char_stream, symbols::Interner& interner)
+		: tokens(char_stream.get_file()), stream(char_stream), end(char_stream.size()), interner(&interner) {};
+
+	Tokenizer::Tokenizer(CharacterStream& char_stream, uint start, uint end)
+		: tokens(char_stream.get_file()), stream(char_stream), position(start), end(end),
+		  is_chunk(true), chunk_interner(std::make_unique<symbols::Interner>()) {
+		this->interner = this->chunk_interner.get();
+	};
+
+
+	void Tokenizer::start(){
+		// rough guess of the token count, avoids most of the regrowth copies on big files
+		this->tokens.reserve((this->end - this->position) / 6);
+
+		auto token = Token();
+		while(this->next(token)){
+			this->tokens.push_back(token);
+		};
 	};
 
 
+	void Tokenizer::start_parallel(uint thread_count){
+		uint chunk_count = std::min(thread_count, this->stream.size() / parallel_chunk_size);
+		if(chunk_count < 2){
+			this->start();
+			return;
+		}
 
-	bool Tokenizer::process_id(){
-		if(this->is_letter() || this->character == '_'){
-			this->move_while([&](){
-				auto peek = this->stream.peek();
-				if(peek.has_value()){
-					return this->is_letter(peek.value()) || this->is_number(peek.value()) || peek.value() == '_';
-				}else{
-					cmd::fatal("Attempted to read past the end of the file");
-					this->error();
-				}
-				return false;
-			});
+		auto chunk_starts = this->find_chunk_starts(chunk_count);
+		chunk_starts.emplace_back(this->stream.size());
 
-			if(this->token_val == "void"){
-				this->make_token(Token::Type::type_void);
-			}else if(this->token_val == "int"){
-				this->make_token(Token::Type::type_int);
-			}else if(this->token_val == "float"){
-				this->make_token(Token::Type::type_float);
-			}else if(this->token_val == "bool"){
-				this->make_token(Token::Type::type_bool);
+		auto chunks = std::vector<Tokenizer>();
+		chunks.reserve(chunk_starts.size() - 1);
+		for(size_t i = 0; i + 1 < chunk_starts.size(); i++){
+			chunks.push_back(Tokenizer(this->stream, chunk_starts[i], chunk_starts[i + 1]));
+		}
 
+		auto threads = std::vector<std::thread>();
+		for(size_t i = 1; i < chunks.size(); i++){
+			threads.emplace_back([&chunk = chunks[i]](){ chunk.start(); });
+		}
+		chunks[0].start();
 
-			}else if(this->token_val == "func"){
-				this->make_token(Token::Type::keyword_func);
-			}else if(this->token_val == "return"){
-				this->make_token(Token::Type::keyword_return);
-			}else if(this->token_val == "if"){
-				this->make_token(Token::Type::keyword_if);
-			}else if(this->token_val == "else"){
-				this->make_token(Token::Type::keyword_else);
+		for(auto& thread : threads){
+			thread.join();
+		}
 
 
-			}else if(this->token_val == "true" || this->token_val == "false"){
-				this->make_token(Token::Type::literal_bool);
+		// start() stops at the first error or '\0', so every chunk after it is thrown away
+		size_t used_chunks = 0;
+		while(used_chunks < chunks.size()){
+			const auto& chunk = chunks[used_chunks];
+			used_chunks += 1;
+			if(!chunk.success() || chunk.position != chunk.end){ break; }
+		};
 
-			
-			}else{
-				this->make_token(Token::Type::id);
+
+		// chunk ids are in order of first appearance in the chunk, so interning them chunk by chunk
+		// 	hands out the shared ids in order of first appearance in the file (same as start())
+		// 	this is the only part that runs in order, every string is interned once per chunk instead of once per token
+		auto& interner = *this->interner;
+		auto symbol_maps = std::vector<std::vector<SymbolId>>(used_chunks);
+		auto offsets = std::vector<size_t>(used_chunks + 1, 0);
+
+		for(size_t i = 0; i < used_chunks; i++){
+			const auto& chunk_interner = *chunks[i].chunk_interner;
+
+			symbol_maps[i].resize(chunk_interner.size());
+			for(SymbolId symbol = 0; symbol < chunk_interner.size(); symbol++){
+				symbol_maps[i][symbol] = interner.intern(chunk_interner.get(symbol));
 			}
 
+			offsets[i + 1] = offsets[i] + chunks[i].tokens.size();
+		}
+
+
+		// stitched back together in file order, each chunk copies itself into its own range
+		this->tokens.resize(offsets.back());
 
-			return true;
+		threads.clear();
+		for(size_t i = 1; i < used_chunks; i++){
+			threads.emplace_back([&, i](){ this->tokens.copy_chunk(offsets[i], chunks[i].tokens, symbol_maps[i]); });
 		}
+		this->tokens.copy_chunk(0, chunks[0].tokens, symbol_maps[0]);
 
-		return false;
+		for(auto& thread : threads){
+			thread.join();
+		}
+
+
+		auto& last_chunk = chunks[used_chunks - 1];
+		this->position = last_chunk.position;
+
+		if(!last_chunk.success()){
+			this->error(std::move(last_chunk.chunk_error.message), last_chunk.chunk_error.start, last_chunk.chunk_error.end);
+		}
 	};
 
 
-	bool Tokenizer::process_number(){
-		if(this->is_number()){
-			this->move_while([&](){
-				auto peek = this->stream.peek();
-				if(peek.has_value()){
-					return this->is_number(peek.value());
-				}else{
-					cmd::fatal("Attempted to read past the end of the file");
-					this->error();
+	std::vector<uint> Tokenizer::find_chunk_starts(uint chunk_count) const {
+		const char* file = this->stream.get_file().data();
+		const uint size = this->stream.size();
+		const auto& scanner = simd::get_scanner();
+
+		auto find = [&](char character, uint from, uint to) -> uint {
+			auto* found = static_cast<const char*>(std::memchr(file + from, character, to - from));
+			return found == nullptr ? to : uint(found - file);
+		};
+
+		auto chunk_starts = std::vector<uint>{0};
+		chunk_starts.reserve(chunk_count + 1);
+
+		auto next_target = [&](){
+			return uint(uint64_t(size) * chunk_starts.size() / chunk_count);
+		};
+
+		uint target = next_target();
+		uint position = 0;
+		uint comment_depth = 0;
+
+		// only comments can hide a newline from the DFA, so this just tracks them (same rules as the comment states)
+		while(position < size && chunk_starts.size() < chunk_count){
+			if(comment_depth == 0){
+				// every line start before the next '/' is outside of a comment
+				uint slash = find('/', position, size);
+
+				while(chunk_starts.size() < chunk_count){
+					uint from = std::max(target, position);
+					if(from >= slash){ break; }
+
+					uint newline = find('\n', from, slash);
+					if(newline == slash || newline + 1 == size){ break; }
+
+					chunk_starts.emplace_back(newline + 1);
+					target = std::max(next_target(), newline + 1);
 				}
-				return false;
-			});
-
-			auto peek = this->stream.peek();
-			if(peek.has_value() && peek.value() == '.'){
-				this->character = this->stream.next().value();
-				this->token_val += this->character;
-
-				this->move_while([&](){
-					auto peek = this->stream.peek();
-					if(peek.has_value()){
-						return this->is_number(peek.value());
-					}else{
-						cmd::fatal("Attempted to read past the end of the file");
-						this->error();
-					}
-					return false;
-				});
 
-				this->make_token(Token::Type::literal_float);
+				if(slash + 1 >= size){ break; }
+
+				switch(file[slash + 1]){
+					break; case '/': position = scanner.find_line_comment_end(file, slash + 2, size);
+					break; case '*': position = slash + 2; comment_depth = 1;
+					break; default:  position = slash + 1;
+				};
+
 			}else{
-				this->make_token(Token::Type::literal_int);
-			}
+				position = scanner.find_block_comment_char(file, position, size);
 
+				// a '\0' in a comment is an error and an unterminated one runs to the end, either way there's nothing left to split
+				if(position == size || file[position] == '\0'){ break; }
 
-			return true;
-		}
+				if(file[position] == '*'){
+					while(position < size && file[position] == '*'){ position += 1; }
+					if(position < size && file[position] == '/'){
+						position += 1;
+						comment_depth -= 1;
+					}
 
+				}else{
+					while(position < size && file[position] == '/'){ position += 1; }
+					if(position < size && file[position] == '*'){
+						position += 1;
+						comment_depth += 1;
+					}
+				}
+			}
+		};
 
-		return false;
+		return chunk_starts;
 	};
 
 
+	bool Tokenizer::next(Token& token){
+		const char* file = this->stream.get_file().data();
+		const uint end = this->end; // end of the chunk (the whole file unless lexing in parallel)
+		const auto& scanner = simd::get_scanner();
 
-	bool Tokenizer::process_operators(){
-		#define SINGLE(c, token) \
-			}else if(this->character == c){ \
-				this->make_token(Token::Type::token); \
-				return true;
+		uint position = this->position;
 
-		#define DOUBLE(c1, c2, token) \
-			}else if(this->character == c1 && this->stream.peek(0) == c2){ \
-				this->character = this->stream.next().value(); \
-				this->token_val += this->character; \
-				this->make_token(Token::Type::token); \
-				return true;
+		while(this->success()){
+			auto state = State::start;
+			uint token_start = position;
+			uint comment_depth = 0;
 
-		// needed to start the macro chain
-		if(false){
+			// run the DFA until there is no transition (longest match)
+			while(true){
+				if(position == end){ break; }
 
+				auto next_state = transitions[size_t(state)][uint8_t(file[position])];
+				if(next_state == State::done){ break; }
 
-		// logical
-		DOUBLE('<', '=', op_lte);
-		DOUBLE('>', '=', op_gte);
-		DOUBLE('=', '=', op_eq);
-		DOUBLE('!', '=', op_neq);
-		DOUBLE('&', '&', op_and);
-		DOUBLE('|', '|', op_gte);
-		SINGLE('<', op_lt);
-		SINGLE('>', op_gt);
+				state = next_state;
+				position += 1;
 
-		// assignment
-		SINGLE('=', assign);
-		SINGLE(':', type_def);
-		SINGLE('@', const_type_def);
+				if(state >= State::block_comment_open){
+					if(state == State::block_comment_open){
+						comment_depth += 1;
+						state = State::block_comment;
+					}else{
+						comment_depth -= 1;
+						state = comment_depth == 0 ? State::block_comment_end : State::block_comment;
+					}
+				}
+
+				// long runs are skipped through in bulk, checking the next char first keeps
+				// single char runs (mostly whitespace) from paying for the call
+				if(state >= State::whitespace && state <= State::block_comment){
+					if(position == end || transitions[size_t(state)][uint8_t(file[position])] != state){ continue; }
+
+					switch(state){
+						break; case State::whitespace:      position = scanner.skip_whitespace(file, position, end);
+						break; case State::id:              position = scanner.skip_id(file, position, end);
+						break; case State::number:          position = scanner.skip_digits(file, position, end);
+						break; case State::number_fraction: position = scanner.skip_digits(file, position, end);
+						break; case State::line_comment:    position = scanner.find_line_comment_end(file, position, end);
+						break; case State::block_comment:   position = scanner.find_block_comment_char(file, position, end);
+						break; default: break;
+					};
+				}
+			};
+
+
+			switch(state){
+				case State::start:
+				case State::eof: {
+					this->position = position;
+					return false;
+				} break;
+
+				case State::whitespace:
+				case State::line_comment:
+				case State::block_comment:
+				case State::block_comment_star:
+				case State::block_comment_slash:
+				case State::block_comment_end: {
+					// skipped
+				} break;
+
+				case State::comment_eof: {
+					this->error("Hit the end of the file (Tokenizer)", token_start, position);
+				} break;
+
+				case State::unknown:
+				case State::bang:
+				case State::amp:
+				case State::pipe: {
+					char character = file[token_start];
+					this->error(fmt::format("Unable to process char [{}] (charcode: {})", character, (uint)character), token_start, position);
+				} break;
+
+				case State::id: {
+					auto value = std::string_view(file + token_start, position - token_start);
+
+					// names are interned here once, every later phase only compares SymbolIds
+					const KeywordInfo* keyword = this->find_keyword(value);
+					if(keyword == nullptr){
+						auto symbol = this->interner->intern(value);
+						token = this->make_token(TokenType::id, token_start, position, symbol);
+					}else{
+						token = this->make_token(keyword->type, token_start, position, keyword->symbol);
+					}
 
-		// arithmetic
-		SINGLE('+', op_plus);
-		SINGLE('-', op_minus);
-		SINGLE('*', op_mult);
-		SINGLE('/', op_div);
+					this->position = position;
+					return true;
+				} break;
 
+				default: {
+					token = this->make_token(accepts[size_t(state)], token_start, position);
+					this->position = position;
+					return true;
+				} break;
+			};
 
-		} return false;
+		};
 
-		#undef SINGLE
-		#undef DOUBLE
+		this->position = position;
+		return false;
 	};
 
 
-	bool Tokenizer::process_punctuation(){
+	void Tokenizer::error(std::string message, uint start, uint end){
+		this->has_errored = true;
 
-		switch(this->character){
-			case ';': this->make_token(Token::Type::semicolon);   return true;
-			case ',': this->make_token(Token::Type::comma); 	  return true;
-			case '(': this->make_token(Token::Type::open_paren);  return true;
-			case ')': this->make_token(Token::Type::close_paren); return true;
-			case '{': this->make_token(Token::Type::open_brace);  return true;
-			case '}': this->make_token(Token::Type::close_brace); return true;
-		};
+		if(this->is_chunk){
+			this->chunk_error = ChunkError(std::move(message), start, end);
+			return;
+		}
+
+		cmd::error("{}", message);
+		auto location = this->stream.get_location(end);
+		cmd::error("\tline:    {}"
+			     "\n\tcollumn: {}", location.line, location.collumn);
+		cmd::error("{}", this->stream.get_snippet(start, end - start));
+	};
 
 
-		return false;
+
+
+	Tokenizer::Token Tokenizer::make_token(Token::Type type, uint start, uint end, SymbolId symbol) const {
+		return Token(type, start, symbol, this->stream.get_file().substr(start, end - start));
 	};
 
 
+	const KeywordInfo* Tokenizer::find_keyword(std::string_view value) const {
+		auto slot = keyword_slots[keyword_hash(value, keyword_seed)];
+		if(slot != no_keyword && keywords[slot].name == value){
+			return &keywords[slot];
+		}
+
+		return nullptr;
+	};
 
 
+	//////////////////////////////////////////////////////////////////////
+	// token buffer
 
+	void Tokenizer::TokenBuffer::reserve(size_t count){
+		this->kinds.reserve(count);
+		this->starts.reserve(count);
+		this->lengths.reserve(count);
+		this->symbol_ids.reserve(count);
+	};
 
-	void Tokenizer::move_while(std::function<bool()> condition){
-		while(!this->stream.end() && condition()){
-			auto next_char = this->stream.next();
-			if(next_char.has_value()){
 
-				this->character = next_char.value();
-				if(this->character == '\0'){
-					// cmd::print("EOF");
-					// break;
-					cmd::error("Hit the end of the file (Tokenizer)");
-					this->error();
-				}
-				this->token_val += this->character;
+	void Tokenizer::TokenBuffer::push_back(const Token& token){
+		this->kinds.emplace_back(uint8_t(token.type));
+		this->starts.emplace_back(token.position);
+		this->lengths.emplace_back(uint32_t(token.value.size()));
+		this->symbol_ids.emplace_back(token.symbol);
+	};
 
-			}else{
-				cmd::error("Attempted to read past the end of the file (Tokenizer)");
-				this->error();
-			}
-		};
+
+	void Tokenizer::TokenBuffer::resize(size_t count){
+		this->kinds.resize(count);
+		this->starts.resize(count);
+		this->lengths.resize(count);
+		this->symbol_ids.resize(count);
 	};
 
 
+	void Tokenizer::TokenBuffer::copy_chunk(size_t offset, const TokenBuffer& chunk, std::span<const SymbolId> symbol_map){
+		std::copy(chunk.kinds.begin(), chunk.kinds.end(), this->kinds.begin() + offset);
+		std::copy(chunk.starts.begin(), chunk.starts.end(), this->starts.begin() + offset);
+		std::copy(chunk.lengths.begin(), chunk.lengths.end(), this->lengths.begin() + offset);
 
-	void Tokenizer::move_while_newline(){
-		this->move_while([&](){
-			return this->character != '\n';
-		});
+		for(size_t i = 0; i < chunk.size(); i++){
+			SymbolId symbol = chunk.symbol_ids[i];
+			this->symbol_ids[offset + i] = symbol == symbols::none ? symbols::none : symbol_map[symbol];
+		}
 	};
 
 
+	void Tokenizer::TokenBuffer::append(const TokenBuffer& other, std::span<const SymbolId> symbol_map){
+		uint32_t offset = this->source_end;
 
+		for(size_t i = 0; i < other.sources.size(); i++){
+			this->sources.emplace_back(other.sources[i]);
+			this->source_starts.emplace_back(other.source_starts[i] + offset);
+		}
+		this->source_end += other.source_end;
 
+		this->kinds.insert(this->kinds.end(), other.kinds.begin(), other.kinds.end());
+		this->lengths.insert(this->lengths.end(), other.lengths.begin(), other.lengths.end());
 
-	//////////////////////////////////////////////////////////////////////
-	// is
-
-
-	bool Tokenizer::is_whitespace(){
-		switch(this->character){
-			case '\n':
-			case '\r':
-			case '\t':
-			case ' ':
-				return true;
-			default:
-				return false;	
-		};
+		for(size_t i = 0; i < other.size(); i++){
+			this->starts.emplace_back(other.starts[i] + offset);
+
+			SymbolId symbol = other.symbol_ids[i];
+			this->symbol_ids.emplace_back(symbol == symbols::none ? symbols::none : symbol_map[symbol]);
+		}
 	};
 
-	bool Tokenizer::is_letter(char _char){
-		switch(_char){
-			case 'a': case 'A':
-			case 'b': case 'B':
-			case 'c': case 'C':
-			case 'd': case 'D':
-			case 'e': case 'E':
-			case 'f': case 'F':
-			case 'g': case 'G':
-			case 'h': case 'H':
-			case 'i': case 'I':
-			case 'j': case 'J':
-			case 'k': case 'K':
-			case 'l': case 'L':
-			case 'm': case 'M':
-			case 'n': case 'N':
-			case 'o': case 'O':
-			case 'p': case 'P':
-			case 'q': case 'Q':
-			case 'r': case 'R':
-			case 's': case 'S':
-			case 't': case 'T':
-			case 'u': case 'U':
-			case 'v': case 'V':
-			case 'w': case 'W':
-			case 'y': case 'Y':
-			case 'z': case 'Z':
-				return true;
-			default:
-				return false;	
-		};
+
+	void Tokenizer::TokenBuffer::set_source(std::string_view source){
+		this->sources.assign(1, source);
+		this->source_starts.assign(1, 0);
+		this->source_end = uint32_t(source.size());
 	};
 
-	bool Tokenizer::is_letter(){
-		return this->is_letter(this->character);
+	void Tokenizer::TokenBuffer::move_positions(uint first, uint last, int offset){
+		for(uint i = first; i < last; i++){
+			this->starts[i] += uint32_t(offset);
+		}
 	};
 
 
-	bool Tokenizer::is_number(char _char){
-		switch(_char){
-			case '0':
-			case '1':
-			case '2':
-			case '3':
-			case '4':
-			case '5':
-			case '6':
-			case '7':
-			case '8':
-			case '9':
-				return true;
-			default:
-				return false;	
-		};
+	void Tokenizer::TokenBuffer::keep(std::span<const uint32_t> new_indices){
+		for(size_t i = 0; i < this->size(); i++){
+			uint32_t index = new_indices[i];
+			if(new_indices[i + 1] == index){ continue; }
+
+			this->kinds[index] = this->kinds[i];
+			this->starts[index] = this->starts[i];
+			this->lengths[index] = this->lengths[i];
+			this->symbol_ids[index] = this->symbol_ids[i];
+		}
+
+		this->resize(new_indices[this->size()]);
 	};
 
-	bool Tokenizer::is_number(){
-		return this->is_number(this->character);
+
+	Tokenizer::Token Tokenizer::TokenBuffer::get(uint index) const {
+		uint start = this->starts[index];
+
+		// generated tokens aren't in the source, they're spelled by their symbol
+		if(this->kind(index) == TokenType::generated){
+			return Token(TokenType::generated, start, this->symbol_ids[index], symbols::get(this->symbol_ids[index]));
+		}
+
+		uint source_position = start;
+		auto source = this->find_source(source_position);
+		return Token(this->kind(index), start, this->symbol_ids[index], source.substr(source_position, this->lengths[index]));
 	};
 
 
+	std::string_view Tokenizer::TokenBuffer::find_source(uint& position) const {
+		if(this->sources.size() == 1){
+			return this->sources[0];
+		}
 
-}
+		// last source that starts at or before `position`
+		auto found = std::upper_bound(this->source_starts.begin(), this->source_starts.end(), position) - 1;
+		position -= *found;
+		return this->sources[found - this->source_starts.begin()];
+	};
 
+
+	void Tokenizer::TokenBuffer::write(std::string& output) const {
+		files::write_array<uint8_t>(output, this->kinds);
+		files::write_array<uint32_t>(output, this->starts);
+		files::write_array<uint32_t>(output, this->lengths);
+		files::write_array<SymbolId>(output, this->symbol_ids);
+	};
+
+	bool Tokenizer::TokenBuffer::read(std::string_view& input, symbols::Interner& interner){
+		if(this->sources.size() != 1){ return false; }
+		auto source = this->sources[0];
+
+		if(!files::read_array(input, this->kinds)){ return false; }
+		if(!files::read_array(input, this->starts)){ return false; }
+		if(!files::read_array(input, this->lengths)){ return false; }
+		if(!files::read_array(input, this->symbol_ids)){ return false; }
+
+		size_t count = this->kinds.size();
+		if(this->starts.size() != count || this->lengths.size() != count || this->symbol_ids.size() != count){
+			return false;
+		}
+
+		// every name is only interned once, at its first use
+		auto symbol_map = std::vector<SymbolId>();
+
+		for(size_t i = 0; i < count; i++){
+			if(size_t(this->starts[i]) + this->lengths[i] > source.size()){ return false; }
+
+			// generated tokens only use the built in symbols, which are the same for every interner
+			SymbolId& symbol = this->symbol_ids[i];
+			if(symbol == symbols::none || this->kind(uint(i)) == TokenType::generated){ continue; }
+
+			if(symbol >= symbol_map.size()){
+				// every name takes at least a byte of the source, so a bigger id can only come from a broken file
+				if(symbol > source.size() + symbols::func_printf){ return false; }
+				symbol_map.resize(symbol + 1, symbols::none);
+			}
+
+			if(symbol_map[symbol] == symbols::none){
+				symbol_map[symbol] = interner.intern(source.substr(this->starts[i], this->lengths[i]));
+			}
+
+			symbol = symbol_map[symbol];
+		}
+
+		return true;
+	};
+
+
+}
@@ -4,57 +4,140 @@
 
 namespace Hawk{
 	class CharacterStream;
+	struct KeywordInfo;
 	
 	class Tokenizer{
 		public:
-			Tokenizer(CharacterStream& char_stream) : stream(char_stream) {};
+			Tokenizer(CharacterStream& char_stream);
+
+			// names are interned into `interner` instead of the shared one (for files lexed on other threads)
+			Tokenizer(CharacterStream& char_stream, symbols::Interner& interner);
 			~Tokenizer() = default;
 
+			Tokenizer(Tokenizer&&) = default;
+
 
+			// lexes the whole file into tokens
 			void start();
 
+			// same tokens as start(), but the file is split at line starts and every chunk is lexed on its own thread
+			// 	files too small to split fall back to start()
+			void start_parallel(uint thread_count);
+
+			// smallest chunk worth giving a thread
+			static constexpr uint parallel_chunk_size = 4 << 20;
+
 			struct Token{
 				enum class Type;
 				Type type;
-				uint line = 0;
-				uint collumn = 0;
-				std::string value = "";
+				uint position = 0; // byte offset into the source (line / collumn are looked up from it when needed)
+				SymbolId symbol = symbols::none; // only set for identifiers and type names
+				std::string_view value{}; // view into the source buffer
+
+				inline uint end() const { return this->position + uint(this->value.size()); };
+			};
+
+
+			// tokens stored as struct-of-arrays (13 bytes a token)
+			// 	looking ahead only touches `kinds`, the full Token is put back together by get()
+			class TokenBuffer{
+				public:
+					TokenBuffer() = default;
+					TokenBuffer(std::string_view source) : sources{source}, source_starts{0}, source_end(uint32_t(source.size())) {};
+					~TokenBuffer() = default;
+
+					void reserve(size_t count);
+					void push_back(const Token& token);
+
+					void resize(size_t count);
 
+					// overwrites [offset, offset + chunk.size()) with the tokens of a chunk, mapping its SymbolIds through `symbol_map`
+					// 	chunks that don't overlap can be copied from different threads
+					void copy_chunk(size_t offset, const TokenBuffer& chunk, std::span<const SymbolId> symbol_map);
+
+					// adds the tokens (and sources) of `other` to the end, mapping its SymbolIds through `symbol_map`
+					// 	its positions are moved past the end of the sources already here, see SourceFiles
+					void append(const TokenBuffer& other, std::span<const SymbolId> symbol_map);
+
+					// for a buffer with a single source, that source changed (see Parser::reparse)
+					// 	the tokens in [first, last) moved by `offset`
+					void set_source(std::string_view source);
+					void move_positions(uint first, uint last, int offset);
+
+					// keeps the token at `i` (moved to new_indices[i]) only if new_indices[i + 1] is past new_indices[i]
+					void keep(std::span<const uint32_t> new_indices);
+
+					inline size_t size() const { return this->kinds.size(); };
+					inline Token::Type kind(uint index) const { return Token::Type(this->kinds[index]); };
+					Token get(uint index) const;
+
+					// raw copy of the arrays (see files::write_array), only for a buffer with a single source
+					// 	SymbolIds are only meaningful to the interner that handed them out, so read() interns the names again
+					void write(std::string& output) const;
+					bool read(std::string_view& input, symbols::Interner& interner);
+
+				private:
+					// the source that `position` is in, `position` is made relative to it
+					std::string_view find_source(uint& position) const;
+
+				private:
+					// one per file, one after another in the same range of positions
+					std::vector<std::string_view> sources;
+					std::vector<uint32_t> source_starts;
+					uint32_t source_end = 0;
+
+					std::vector<uint8_t> kinds;
+					std::vector<uint32_t> starts;
+					std::vector<uint32_t> lengths;
+					std::vector<SymbolId> symbol_ids;
 			};
 
+
+			// lexes only the next token (streaming), returns false at the end of the file or on an error
+			bool next(Token& token);
+
+			// next() continues from `position`, which must not be inside a token or a comment
+			inline void seek(uint position){ this->position = position; };
+
 			inline bool success() const { return !this->has_errored; };
+			inline const CharacterStream& get_stream() const { return this->stream; };
 
 		public:
-			std::vector<Token> tokens;
+			TokenBuffer tokens;
 
 		private:
-			void make_token(Token::Type type);
-			void process_char();
-
-			bool process_comments();
-			bool process_id();
-			bool process_number();
-			bool process_operators();
-			bool process_punctuation();
+			// lexes [start, end) of the file for start_parallel()
+			Tokenizer(CharacterStream& char_stream, uint start, uint end);
 
-			void move_while(std::function<bool()> condition);
-			void move_while_newline();
+			// every chunk starts at the beginning of a line that is outside of any comment
+			std::vector<uint> find_chunk_starts(uint chunk_count) const;
 
-			bool is_whitespace();
-			bool is_letter(char _char);
-			bool is_letter();
-			bool is_number(char _char);
-			bool is_number();
+			Token make_token(Token::Type type, uint start, uint end, SymbolId symbol = symbols::none) const;
+			const KeywordInfo* find_keyword(std::string_view value) const;
 
-			void error();
+			void error(std::string message, uint start, uint end);
 
 		private:
 			CharacterStream& stream;
 			
-			char character;
-			std::string token_val = "";
+			uint position = 0;
+			uint end;
 
 			bool has_errored = false;
+
+			symbols::Interner* interner;
+
+			// chunks lexed on other threads can't use the shared interner (it isn't thread safe) or print
+			// 	their errors (only the first one in the file is reported), start_parallel() does both in file order
+			struct ChunkError{
+				std::string message;
+				uint start;
+				uint end;
+			};
+
+			bool is_chunk = false;
+			std::unique_ptr<symbols::Interner> chunk_interner{};
+			ChunkError chunk_error{};
 	};
 
 
@@ -113,6 +196,52 @@ namespace Hawk{
 
 	using TokenType = Tokenizer::Token::Type;
 
+	// TokenBuffer stores kinds as uint8_t
+	static_assert(size_t(TokenType::close_brace) <= 0xFF);
+
+
+
+	//////////////////////////////////////////////////////////////////////
+	// keywords
+
+	// every reserved word - the Tokenizer builds its keyword hash from this and the Parser prints from it
+	struct KeywordInfo{
+		enum class Kind{
+			keyword,
+			type,
+			literal,
+		};
+
+		std::string_view name;
+		TokenType type;
+		Kind kind;
+		SymbolId symbol = symbols::none;
+	};
+
+	inline constexpr auto keywords = std::to_array<KeywordInfo>({
+		{"func",   TokenType::keyword_func,   KeywordInfo::Kind::keyword},
+		{"return", TokenType::keyword_return, KeywordInfo::Kind::keyword},
+		{"if",     TokenType::keyword_if,     KeywordInfo::Kind::keyword},
+		{"else",   TokenType::keyword_else,   KeywordInfo::Kind::keyword},
+
+		{"void",   TokenType::type_void,      KeywordInfo::Kind::type, symbols::type_void},
+		{"int",    TokenType::type_int,       KeywordInfo::Kind::type, symbols::type_int},
+		{"float",  TokenType::type_float,     KeywordInfo::Kind::type, symbols::type_float},
+		{"bool",   TokenType::type_bool,      KeywordInfo::Kind::type, symbols::type_bool},
+
+		{"true",   TokenType::literal_bool,   KeywordInfo::Kind::literal},
+		{"false",  TokenType::literal_bool,   KeywordInfo::Kind::literal},
+	});
+
+
+	// returns nullptr if the token type is not a reserved word
+	constexpr const KeywordInfo* get_keyword_info(TokenType type){
+		for(const auto& keyword : keywords){
+			if(keyword.type == type){ return &keyword; }
+		}
+		return nullptr;
+	};
+
 
 }
 
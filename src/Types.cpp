@@ -0,0 +1,33 @@
+#include "pch.h"
+#include "Types.h"
+
+
+namespace Hawk::types{
+
+	Table::Table(){
+		// must match the order of the constants in Types.h
+		this->get(symbols::type_void);
+		this->get(symbols::type_int);
+		this->get(symbols::type_float);
+		this->get(symbols::type_bool);
+	};
+
+
+	TypeId Table::get(SymbolId name){
+		if(auto* type = this->ids.find(name); type != nullptr){
+			return *type;
+		}
+
+		auto type = TypeId(this->names.size());
+		this->ids[name] = type;
+		this->names.push_back(name);
+		return type;
+	};
+
+
+	std::string_view Table::print(TypeId type) const {
+		if(type == none){ return "unknown"; }
+		return symbols::get(this->names[type]);
+	};
+
+}
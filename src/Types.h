@@ -0,0 +1,46 @@
+#pragma once
+
+
+namespace Hawk::types{
+
+	// every type has exactly one TypeId, so types are compared by comparing ids
+	// 	the built in types have fixed ids (they can be switched on), other type names get the next id when first seen
+	using TypeId = uint32_t;
+
+	constexpr TypeId none = ~TypeId(0);
+
+	// registered by every Table on construction (in this order)
+	constexpr TypeId type_void  = 0;
+	constexpr TypeId type_int   = 1;
+	constexpr TypeId type_float = 2;
+	constexpr TypeId type_bool  = 3;
+
+
+
+	// the types of a program, made by the SemanticAnalyzer and read by the Compiler
+	class Table{
+		public:
+			Table();
+			~Table() = default;
+
+			// the type named `name` (a built in type or not)
+			TypeId get(SymbolId name);
+
+			inline SymbolId get_name(TypeId type) const { return this->names[type]; };
+
+			// for errors ("unknown" for none)
+			std::string_view print(TypeId type) const;
+
+			inline size_t size() const { return this->names.size(); };
+
+		private:
+			symbols::Map<TypeId> ids;
+			std::vector<SymbolId> names;
+	};
+
+}
+
+
+namespace Hawk{
+	using types::TypeId;
+}
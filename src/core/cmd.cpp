@@ -4,10 +4,31 @@
 
 namespace Hawk::cmd{
 
+	static thread_local std::string* captured_output = nullptr;
+
 	void out(const char* str){
+		if(captured_output != nullptr){
+			captured_output->append(str);
+			captured_output->append("\x1b[0m");
+			return;
+		}
+
 		printf("%s%s", str, "\x1b[0m");
 	};
 
+	std::string* capture_output(std::string* buffer){
+		return std::exchange(captured_output, buffer);
+	};
+
+	void out_captured(std::string_view output){
+		if(captured_output != nullptr){
+			captured_output->append(output);
+			return;
+		}
+
+		std::fwrite(output.data(), 1, output.size(), stdout);
+	};
+
 
 
 
@@ -19,6 +40,10 @@ namespace Hawk::cmd{
 		should_use_color = false;
 	};
 
+	void use_color(){
+		should_use_color = true;
+	};
+
 	bool using_color(){
 		return should_use_color;
 	};
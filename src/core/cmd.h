@@ -16,6 +16,14 @@ namespace Hawk::cmd{
 
 	void out(const char* str);
 
+	// output of the calling thread is added to `buffer` instead of printed, until it's set back to nullptr
+	// 	(files parsed on other threads print their errors in file order once they're all done)
+	// 	returns the buffer it replaces (so a nested capture can put it back)
+	std::string* capture_output(std::string* buffer);
+
+	// adds output captured with capture_output() to the output of the calling thread as it is
+	void out_captured(std::string_view output);
+
 
 	template<typename... Args>
 	void print(const char* str, Args&&... args){
@@ -44,6 +52,7 @@ namespace Hawk::cmd{
 
 
 	void use_no_color();
+	void use_color();
 	bool using_color();
 
 
@@ -1,5 +1,16 @@
 #include "pch.h"
 
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
 
 namespace Hawk::files{
 
@@ -34,5 +45,205 @@ namespace Hawk::files{
 	    out.append(buf, 0, stream.gcount());
 	    return out;
 	}
+
+
+	bool write(const fs::path& path, std::string_view data){
+		// named after the thread, in case two threads write the same file
+		auto temp_path = path;
+		temp_path += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+		{
+			auto stream = std::ofstream(temp_path, std::ios::binary | std::ios::trunc);
+			if(!stream.is_open()){ return false; }
+
+			stream.write(data.data(), std::streamsize(data.size()));
+			if(!stream.good()){ return false; }
+		}
+
+		auto error = std::error_code();
+		fs::rename(temp_path, path, error);
+		if(error){
+			fs::remove(temp_path, error);
+			return false;
+		}
+
+		return true;
+	};
+
+
+
+	//////////////////////////////////////////////////////////////////////
+	// hash
+
+	static inline uint64_t hash_mix(uint64_t value){
+		value ^= value >> 33;
+		value *= 0xFF51AFD7ED558CCDull;
+		value ^= value >> 33;
+		value *= 0xC4CEB9FE1A85EC53ull;
+		value ^= value >> 33;
+		return value;
+	};
+
+	uint64_t hash(std::string_view data, uint64_t seed){
+		constexpr uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+
+		uint64_t output = seed ^ (data.size() * multiplier);
+
+		size_t i = 0;
+		for(; i + 8 <= data.size(); i += 8){
+			uint64_t word;
+			std::memcpy(&word, data.data() + i, 8);
+			output = std::rotl(output ^ (word * multiplier), 29) * multiplier;
+		}
+
+		// last 1-7 bytes
+		if(i < data.size()){
+			uint64_t tail = 0;
+			std::memcpy(&tail, data.data() + i, data.size() - i);
+			output ^= tail * multiplier;
+		}
+
+		return hash_mix(output);
+	};
+
+
+
+	//////////////////////////////////////////////////////////////////////
+	// MappedFile
+
+	MappedFile::~MappedFile(){
+		this->close();
+	};
+
+
+	#if defined(_WIN32)
+
+		bool MappedFile::open(const fs::path& path){
+			this->close();
+
+			auto file = CreateFileW(
+				path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+			);
+			if(file == INVALID_HANDLE_VALUE){
+				return this->read_once(path);
+			}
+
+			LARGE_INTEGER file_size;
+			if(GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &file_size)){
+				CloseHandle(file);
+				return this->read_once(path);
+			}
+
+			// empty files can't be mapped
+			if(file_size.QuadPart == 0){
+				CloseHandle(file);
+				return true;
+			}
+
+			auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if(mapping == nullptr){
+				CloseHandle(file);
+				return this->read_once(path);
+			}
+
+			auto* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if(view == nullptr){
+				CloseHandle(mapping);
+				CloseHandle(file);
+				return this->read_once(path);
+			}
+
+			this->file_handle = file;
+			this->mapping_handle = mapping;
+			this->data = static_cast<const char*>(view);
+			this->size = static_cast<size_t>(file_size.QuadPart);
+			this->mapped = true;
+			return true;
+		};
+
+
+		void MappedFile::close(){
+			if(this->mapped){
+				UnmapViewOfFile(this->data);
+				CloseHandle(this->mapping_handle);
+				CloseHandle(this->file_handle);
+
+				this->file_handle = nullptr;
+				this->mapping_handle = nullptr;
+			}
+
+			this->fallback.clear();
+			this->data = nullptr;
+			this->size = 0;
+			this->mapped = false;
+		};
+
+	#else
+
+		bool MappedFile::open(const fs::path& path){
+			this->close();
+
+			int file = ::open(path.c_str(), O_RDONLY);
+			if(file == -1){
+				return false;
+			}
+
+			struct stat file_stat;
+			if(fstat(file, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)){
+				::close(file);
+				return this->read_once(path);
+			}
+
+			// empty files can't be mapped
+			if(file_stat.st_size == 0){
+				::close(file);
+				return true;
+			}
+
+			auto* view = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+			::close(file);
+
+			if(view == MAP_FAILED){
+				return this->read_once(path);
+			}
+
+			// the tokenizer walks the file front to back exactly once
+			madvise(view, file_stat.st_size, MADV_SEQUENTIAL);
+
+			this->data = static_cast<const char*>(view);
+			this->size = static_cast<size_t>(file_stat.st_size);
+			this->mapped = true;
+			return true;
+		};
+
+
+		void MappedFile::close(){
+			if(this->mapped){
+				munmap(const_cast<char*>(this->data), this->size);
+			}
+
+			this->fallback.clear();
+			this->data = nullptr;
+			this->size = 0;
+			this->mapped = false;
+		};
+
+	#endif
+
+
+	// used for anything that can't be mapped (pipes, character devices, ...)
+	bool MappedFile::read_once(const fs::path& path){
+		auto stream = std::ifstream(path, std::ios::binary);
+		if(!stream.is_open()){
+			return false;
+		}
+
+		this->fallback.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+		this->data = this->fallback.data();
+		this->size = this->fallback.size();
+		this->mapped = false;
+		return true;
+	};
 	
 }
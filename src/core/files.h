@@ -5,6 +5,97 @@ namespace Hawk::files{
 
 	std::string read(fs::path&& path);
 	std::string read(const fs::path& path);
+
+	// writes to a temporary file first, so readers never see a partly written file
+	bool write(const fs::path& path, std::string_view data);
+
+
+	// fast non-cryptographic hash of a whole buffer (8 bytes at a time)
+	uint64_t hash(std::string_view data, uint64_t seed = 0);
+
+
+	// read-only view of a file's contents
+	// 	regular files are memory-mapped, anything else (pipes, devices) is read once into an owned buffer
+	class MappedFile{
+		public:
+			MappedFile() = default;
+			~MappedFile();
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			bool open(const fs::path& path);
+			void close();
+
+			inline std::string_view view() const { return std::string_view(this->data, this->size); };
+			inline bool is_mapped() const { return this->mapped; };
+
+		private:
+			bool read_once(const fs::path& path);
+
+		private:
+			const char* data = nullptr;
+			size_t size = 0;
+			bool mapped = false;
+
+			std::string fallback{};
+
+			#if defined(_WIN32)
+				void* file_handle = nullptr;
+				void* mapping_handle = nullptr;
+			#endif
+	};
 	
-}
 
+
+
+	//////////////////////////////////////////////////////////////////////
+	// binary blobs
+
+	// values are written as raw bytes and padded to 8 bytes, so a blob that's mapped at an aligned address can be used in place
+	// 	only for types that are trivially copyable and hold no pointers
+
+	template<typename T>
+	void write_value(std::string& output, const T& value){
+		static_assert(std::is_trivially_copyable_v<T>);
+		output.append(reinterpret_cast<const char*>(&value), sizeof(T));
+		output.resize((output.size() + 7) & ~size_t(7), '\0');
+	};
+
+	template<typename T>
+	bool read_value(std::string_view& input, T& value){
+		static_assert(std::is_trivially_copyable_v<T>);
+		size_t padded_size = (sizeof(T) + 7) & ~size_t(7);
+		if(input.size() < padded_size){ return false; }
+
+		std::memcpy(&value, input.data(), sizeof(T));
+		input.remove_prefix(padded_size);
+		return true;
+	};
+
+
+	template<typename T>
+	void write_array(std::string& output, std::span<const T> array){
+		static_assert(std::is_trivially_copyable_v<T>);
+		write_value(output, uint64_t(array.size()));
+		output.append(reinterpret_cast<const char*>(array.data()), array.size_bytes());
+		output.resize((output.size() + 7) & ~size_t(7), '\0');
+	};
+
+	template<typename T>
+	bool read_array(std::string_view& input, std::vector<T>& array){
+		static_assert(std::is_trivially_copyable_v<T>);
+		uint64_t count;
+		if(!read_value(input, count)){ return false; }
+
+		if(count > input.size() / sizeof(T)){ return false; }
+		size_t padded_size = (count * sizeof(T) + 7) & ~size_t(7);
+		if(input.size() < padded_size){ return false; }
+
+		array.resize(count);
+		std::memcpy(array.data(), input.data(), count * sizeof(T));
+		input.remove_prefix(padded_size);
+		return true;
+	};
+	
+}
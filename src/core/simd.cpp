@@ -0,0 +1,321 @@
+#include "pch.h"
+#include "simd.h"
+
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+	#define HAWK_SIMD_X86
+
+	#include <immintrin.h>
+
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+
+		// MSVC allows any intrinsic in any function
+		#define HAWK_TARGET_AVX2
+	#else
+		#define HAWK_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
+
+namespace Hawk::simd{
+
+	//////////////////////////////////////////////////////////////////////
+	// scalar
+
+	static inline bool is_whitespace(char c){
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	};
+
+	static inline bool is_digit(char c){
+		return c >= '0' && c <= '9';
+	};
+
+	static inline bool is_id(char c){
+		auto lower = char(c | 0x20);
+		return (lower >= 'a' && lower <= 'z') || is_digit(c) || c == '_';
+	};
+
+	static inline bool is_line_comment_end(char c){
+		return c == '\n' || c == '\0';
+	};
+
+	static inline bool is_block_comment_char(char c){
+		return c == '*' || c == '/' || c == '\0';
+	};
+
+	static inline bool is_newline(char c){
+		return c == '\n';
+	};
+
+
+	template<bool(*in_run)(char)>
+	static uint scalar_skip(const char* data, uint position, uint end){
+		while(position < end && in_run(data[position])){
+			position += 1;
+		}
+		return position;
+	};
+
+	template<bool(*is_target)(char)>
+	static uint scalar_find(const char* data, uint position, uint end){
+		while(position < end && !is_target(data[position])){
+			position += 1;
+		}
+		return position;
+	};
+
+
+
+	#if defined(HAWK_SIMD_X86)
+
+		//////////////////////////////////////////////////////////////////////
+		// sse2
+
+		// chars are compared as signed bytes, so anything >= 0x80 is negative and never in a range
+		static inline __m128i sse2_in_range(__m128i chars, char low, char high){
+			return _mm_and_si128(
+				_mm_cmpgt_epi8(chars, _mm_set1_epi8(low - 1)),
+				_mm_cmplt_epi8(chars, _mm_set1_epi8(high + 1))
+			);
+		};
+
+		static inline __m128i sse2_whitespace(__m128i chars){
+			return _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')),  _mm_cmpeq_epi8(chars, _mm_set1_epi8('\t'))),
+				_mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('\n')))
+			);
+		};
+
+		static inline __m128i sse2_digit(__m128i chars){
+			return sse2_in_range(chars, '0', '9');
+		};
+
+		static inline __m128i sse2_id(__m128i chars){
+			auto lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+			return _mm_or_si128(
+				_mm_or_si128(sse2_in_range(lower, 'a', 'z'), sse2_digit(chars)),
+				_mm_cmpeq_epi8(chars, _mm_set1_epi8('_'))
+			);
+		};
+
+		static inline __m128i sse2_line_comment_end(__m128i chars){
+			return _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(chars, _mm_setzero_si128()));
+		};
+
+		static inline __m128i sse2_block_comment_char(__m128i chars){
+			return _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('*')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'))),
+				_mm_cmpeq_epi8(chars, _mm_setzero_si128())
+			);
+		};
+
+		static inline __m128i sse2_newline(__m128i chars){
+			return _mm_cmpeq_epi8(chars, _mm_set1_epi8('\n'));
+		};
+
+
+		template<__m128i(*in_run)(__m128i), bool(*scalar_in_run)(char)>
+		static uint sse2_skip(const char* data, uint position, uint end){
+			while(position + 16 <= end){
+				auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+				auto outside = uint(_mm_movemask_epi8(in_run(chars))) ^ 0xFFFFu;
+				if(outside != 0){
+					return position + std::countr_zero(outside);
+				}
+				position += 16;
+			};
+
+			return scalar_skip<scalar_in_run>(data, position, end);
+		};
+
+		template<__m128i(*is_target)(__m128i), bool(*scalar_is_target)(char)>
+		static uint sse2_find(const char* data, uint position, uint end){
+			while(position + 16 <= end){
+				auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+				auto found = uint(_mm_movemask_epi8(is_target(chars)));
+				if(found != 0){
+					return position + std::countr_zero(found);
+				}
+				position += 16;
+			};
+
+			return scalar_find<scalar_is_target>(data, position, end);
+		};
+
+
+
+		//////////////////////////////////////////////////////////////////////
+		// avx2
+
+		HAWK_TARGET_AVX2 static inline __m256i avx2_in_range(__m256i chars, char low, char high){
+			return _mm256_and_si256(
+				_mm256_cmpgt_epi8(chars, _mm256_set1_epi8(low - 1)),
+				_mm256_cmpgt_epi8(_mm256_set1_epi8(high + 1), chars)
+			);
+		};
+
+		HAWK_TARGET_AVX2 static inline __m256i avx2_whitespace(__m256i chars){
+			return _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' ')),  _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\t'))),
+				_mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\n')))
+			);
+		};
+
+		HAWK_TARGET_AVX2 static inline __m256i avx2_digit(__m256i chars){
+			return avx2_in_range(chars, '0', '9');
+		};
+
+		HAWK_TARGET_AVX2 static inline __m256i avx2_id(__m256i chars){
+			auto lower = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+			return _mm256_or_si256(
+				_mm256_or_si256(avx2_in_range(lower, 'a', 'z'), avx2_digit(chars)),
+				_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('_'))
+			);
+		};
+
+		HAWK_TARGET_AVX2 static inline __m256i avx2_line_comment_end(__m256i chars){
+			return _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(chars, _mm256_setzero_si256()));
+		};
+
+		HAWK_TARGET_AVX2 static inline __m256i avx2_block_comment_char(__m256i chars){
+			return _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('*')), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('/'))),
+				_mm256_cmpeq_epi8(chars, _mm256_setzero_si256())
+			);
+		};
+
+		HAWK_TARGET_AVX2 static inline __m256i avx2_newline(__m256i chars){
+			return _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\n'));
+		};
+
+
+		// most runs are short (identifiers, indentation), so the remainder goes through sse2 before scalar
+		template<__m256i(*in_run)(__m256i), __m128i(*sse2_in_run)(__m128i), bool(*scalar_in_run)(char)>
+		HAWK_TARGET_AVX2 static uint avx2_skip(const char* data, uint position, uint end){
+			while(position + 32 <= end){
+				auto chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+				auto outside = ~uint(_mm256_movemask_epi8(in_run(chars)));
+				if(outside != 0){
+					return position + std::countr_zero(outside);
+				}
+				position += 32;
+			};
+
+			return sse2_skip<sse2_in_run, scalar_in_run>(data, position, end);
+		};
+
+		template<__m256i(*is_target)(__m256i), __m128i(*sse2_is_target)(__m128i), bool(*scalar_is_target)(char)>
+		HAWK_TARGET_AVX2 static uint avx2_find(const char* data, uint position, uint end){
+			while(position + 32 <= end){
+				auto chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+				auto found = uint(_mm256_movemask_epi8(is_target(chars)));
+				if(found != 0){
+					return position + std::countr_zero(found);
+				}
+				position += 32;
+			};
+
+			return sse2_find<sse2_is_target, scalar_is_target>(data, position, end);
+		};
+
+
+
+		//////////////////////////////////////////////////////////////////////
+		// cpu detection
+
+		static bool cpu_supports_avx2(){
+			#if defined(_MSC_VER)
+				int info[4];
+				__cpuid(info, 0);
+				if(info[0] < 7){ return false; }
+
+				__cpuid(info, 1);
+				bool has_osxsave = (info[2] & (1 << 27)) != 0;
+				bool has_avx = (info[2] & (1 << 28)) != 0;
+				if(!has_osxsave || !has_avx){ return false; }
+
+				// the OS has to save the ymm registers
+				if((_xgetbv(0) & 0x6) != 0x6){ return false; }
+
+				__cpuidex(info, 7, 0);
+				return (info[1] & (1 << 5)) != 0;
+			#else
+				return __builtin_cpu_supports("avx2");
+			#endif
+		};
+
+	#endif
+
+
+
+	//////////////////////////////////////////////////////////////////////
+	// dispatch
+
+	static constexpr Scanner scalar_scanner = {
+		.skip_whitespace         = scalar_skip<is_whitespace>,
+		.skip_id                 = scalar_skip<is_id>,
+		.skip_digits             = scalar_skip<is_digit>,
+		.find_line_comment_end   = scalar_find<is_line_comment_end>,
+		.find_block_comment_char = scalar_find<is_block_comment_char>,
+		.find_newline            = scalar_find<is_newline>,
+		.instruction_set         = InstructionSet::scalar,
+	};
+
+	#if defined(HAWK_SIMD_X86)
+		static constexpr Scanner sse2_scanner = {
+			.skip_whitespace         = sse2_skip<sse2_whitespace, is_whitespace>,
+			.skip_id                 = sse2_skip<sse2_id, is_id>,
+			.skip_digits             = sse2_skip<sse2_digit, is_digit>,
+			.find_line_comment_end   = sse2_find<sse2_line_comment_end, is_line_comment_end>,
+			.find_block_comment_char = sse2_find<sse2_block_comment_char, is_block_comment_char>,
+			.find_newline            = sse2_find<sse2_newline, is_newline>,
+			.instruction_set         = InstructionSet::sse2,
+		};
+
+		static constexpr Scanner avx2_scanner = {
+			.skip_whitespace         = avx2_skip<avx2_whitespace, sse2_whitespace, is_whitespace>,
+			.skip_id                 = avx2_skip<avx2_id, sse2_id, is_id>,
+			.skip_digits             = avx2_skip<avx2_digit, sse2_digit, is_digit>,
+			.find_line_comment_end   = avx2_find<avx2_line_comment_end, sse2_line_comment_end, is_line_comment_end>,
+			.find_block_comment_char = avx2_find<avx2_block_comment_char, sse2_block_comment_char, is_block_comment_char>,
+			.find_newline            = avx2_find<avx2_newline, sse2_newline, is_newline>,
+			.instruction_set         = InstructionSet::avx2,
+		};
+	#endif
+
+
+	const Scanner& get_scanner(InstructionSet instruction_set){
+		#if defined(HAWK_SIMD_X86)
+			switch(instruction_set){
+				case InstructionSet::sse2: return sse2_scanner;
+				case InstructionSet::avx2: return cpu_supports_avx2() ? avx2_scanner : sse2_scanner;
+				default: break;
+			};
+		#endif
+
+		return scalar_scanner;
+	};
+
+
+	const Scanner& get_scanner(){
+		#if defined(HAWK_SIMD_X86)
+			// sse2 is always available on x86-64
+			static const Scanner& best = cpu_supports_avx2() ? avx2_scanner : sse2_scanner;
+			return best;
+		#else
+			return scalar_scanner;
+		#endif
+	};
+
+
+	const char* print_instruction_set(InstructionSet instruction_set){
+		switch(instruction_set){
+			case InstructionSet::scalar: return "scalar";
+			case InstructionSet::sse2:   return "SSE2";
+			case InstructionSet::avx2:   return "AVX2";
+			default:                     return "[UNKNOWN INSTRUCTION SET]";
+		};
+	};
+
+}
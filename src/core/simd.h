@@ -0,0 +1,34 @@
+#pragma once
+
+
+namespace Hawk::simd{
+
+	enum class InstructionSet{
+		scalar,
+		sse2,
+		avx2,
+	};
+
+
+	// every function returns the position of the first char in [position, end) that ends the run, or end
+	struct Scanner{
+		uint (*skip_whitespace)(const char* data, uint position, uint end);
+		uint (*skip_id)(const char* data, uint position, uint end);     // [a-zA-Z0-9_]
+		uint (*skip_digits)(const char* data, uint position, uint end);
+
+		uint (*find_line_comment_end)(const char* data, uint position, uint end);  // '\n' or '\0'
+		uint (*find_block_comment_char)(const char* data, uint position, uint end); // '*', '/' or '\0'
+		uint (*find_newline)(const char* data, uint position, uint end);
+
+		InstructionSet instruction_set;
+	};
+
+
+	const Scanner& get_scanner(InstructionSet instruction_set);
+
+	// the best scanner the cpu supports (checked once)
+	const Scanner& get_scanner();
+
+	const char* print_instruction_set(InstructionSet instruction_set);
+
+}
@@ -0,0 +1,186 @@
+#include "pch.h"
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <winsock2.h>
+	#include <afunix.h>
+#else
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+#endif
+
+
+namespace Hawk::sockets{
+
+	#if defined(_WIN32)
+
+		using Socket = SOCKET;
+
+		static bool startup(){
+			static bool started = [](){
+				WSADATA data;
+				return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+			}();
+			return started;
+		};
+
+		static void close_socket(Socket socket){ closesocket(socket); };
+
+		constexpr int send_flags = 0;
+
+	#else
+
+		using Socket = int;
+
+		static bool startup(){ return true; };
+
+		static void close_socket(Socket socket){ ::close(socket); };
+
+		// a client that went away shouldn't kill the server with SIGPIPE
+		#if defined(MSG_NOSIGNAL)
+			constexpr int send_flags = MSG_NOSIGNAL;
+		#else
+			constexpr int send_flags = 0;
+		#endif
+
+	#endif
+
+
+	static Socket make_socket(const fs::path& path, sockaddr_un& address){
+		if(!startup()){ return Socket(~uintptr_t(0)); }
+
+		address = {};
+		address.sun_family = AF_UNIX;
+
+		auto path_string = path.string();
+		if(path_string.size() >= sizeof(address.sun_path)){ return Socket(~uintptr_t(0)); }
+		std::memcpy(address.sun_path, path_string.data(), path_string.size());
+
+		auto socket_handle = socket(AF_UNIX, SOCK_STREAM, 0);
+
+		#if defined(SO_NOSIGPIPE)
+			int value = 1;
+			setsockopt(socket_handle, SOL_SOCKET, SO_NOSIGPIPE, &value, sizeof(value));
+		#endif
+
+		return socket_handle;
+	};
+
+
+
+	//////////////////////////////////////////////////////////////////////
+	// Connection
+
+	Connection::~Connection(){
+		this->close();
+	};
+
+	void Connection::close(){
+		if(this->handle != invalid){
+			close_socket(Socket(this->handle));
+			this->handle = invalid;
+		}
+	};
+
+
+	bool Connection::send(std::string_view message){
+		uint64_t size = message.size();
+		return this->send_all(reinterpret_cast<const char*>(&size), sizeof(size)) && this->send_all(message.data(), message.size());
+	};
+
+	bool Connection::receive(std::string& message){
+		uint64_t size = 0;
+		if(!this->receive_all(reinterpret_cast<char*>(&size), sizeof(size))){ return false; }
+
+		message.resize(size);
+		return this->receive_all(message.data(), message.size());
+	};
+
+
+	bool Connection::send_all(const char* data, size_t size){
+		while(size > 0){
+			auto sent = ::send(Socket(this->handle), data, int(std::min<size_t>(size, 1 << 30)), send_flags);
+			if(sent <= 0){ return false; }
+
+			data += sent;
+			size -= size_t(sent);
+		};
+
+		return true;
+	};
+
+	bool Connection::receive_all(char* data, size_t size){
+		while(size > 0){
+			auto received = ::recv(Socket(this->handle), data, int(std::min<size_t>(size, 1 << 30)), 0);
+			if(received <= 0){ return false; }
+
+			data += received;
+			size -= size_t(received);
+		};
+
+		return true;
+	};
+
+
+
+	Connection connect(const fs::path& path){
+		sockaddr_un address;
+		auto socket_handle = make_socket(path, address);
+		auto connection = Connection(uintptr_t(socket_handle));
+
+		if(connection.is_open() && ::connect(socket_handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0){
+			connection.close();
+		}
+
+		return connection;
+	};
+
+
+
+	//////////////////////////////////////////////////////////////////////
+	// Listener
+
+	Listener::~Listener(){
+		this->close();
+	};
+
+
+	bool Listener::open(const fs::path& path){
+		this->close();
+
+		sockaddr_un address;
+		auto socket_handle = make_socket(path, address);
+		if(uintptr_t(socket_handle) == Connection::invalid){ return false; }
+
+		auto error_code = std::error_code();
+		fs::remove(path, error_code);
+
+		if(bind(socket_handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(socket_handle, 16) != 0){
+			close_socket(socket_handle);
+			return false;
+		}
+
+		this->handle = uintptr_t(socket_handle);
+		this->path = path;
+		return true;
+	};
+
+
+	void Listener::close(){
+		if(this->handle == Connection::invalid){ return; }
+
+		close_socket(Socket(this->handle));
+		this->handle = Connection::invalid;
+
+		auto error_code = std::error_code();
+		fs::remove(this->path, error_code);
+	};
+
+
+	Connection Listener::accept(){
+		return Connection(uintptr_t(::accept(Socket(this->handle), nullptr, nullptr)));
+	};
+
+}
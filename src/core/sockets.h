@@ -0,0 +1,65 @@
+#pragma once
+
+
+namespace Hawk::sockets{
+
+	// a connection over a local (Unix domain) socket
+	// 	messages are sent with their size in front, so a receive() always gets a whole message
+	class Connection{
+		public:
+			Connection() = default;
+			~Connection();
+
+			Connection(const Connection&) = delete;
+			Connection& operator=(const Connection&) = delete;
+
+			Connection(Connection&& other) : handle(std::exchange(other.handle, invalid)) {};
+
+			bool send(std::string_view message);
+			bool receive(std::string& message);
+
+			void close();
+
+			inline bool is_open() const { return this->handle != invalid; };
+
+		private:
+			Connection(uintptr_t socket_handle) : handle(socket_handle) {};
+
+			bool send_all(const char* data, size_t size);
+			bool receive_all(char* data, size_t size);
+
+		private:
+			// SOCKET on windows, a file descriptor everywhere else
+			static constexpr uintptr_t invalid = ~uintptr_t(0);
+			uintptr_t handle = invalid;
+
+			friend class Listener;
+			friend Connection connect(const fs::path& path);
+	};
+
+
+	// the returned connection isn't open if nothing is listening at `path`
+	Connection connect(const fs::path& path);
+
+
+	class Listener{
+		public:
+			Listener() = default;
+			~Listener();
+
+			Listener(const Listener&) = delete;
+			Listener& operator=(const Listener&) = delete;
+
+			// a socket file left at `path` by a listener that didn't close is replaced
+			bool open(const fs::path& path);
+			void close();
+
+			// waits for the next connection
+			Connection accept();
+
+		private:
+			uintptr_t handle = Connection::invalid;
+			fs::path path{};
+	};
+
+}
@@ -0,0 +1,103 @@
+#include "pch.h"
+#include "symbols.h"
+
+
+namespace Hawk::symbols{
+
+	static constexpr size_t block_size = 64 * 1024;
+
+
+	Interner::Interner(){
+		this->slots.assign(1024, none);
+
+		// must match the order of the constants in symbols.h
+		this->intern("void");
+		this->intern("int");
+		this->intern("float");
+		this->intern("bool");
+		this->intern("printf");
+	};
+
+
+	SymbolId Interner::intern(std::string_view str){
+		auto hash = uint32_t(std::hash<std::string_view>{}(str));
+
+		uint slot = this->find_slot(str, hash);
+		if(this->slots[slot] != none){
+			return this->slots[slot];
+		}
+
+		auto symbol = SymbolId(this->strings.size());
+		this->strings.emplace_back(this->store(str));
+		this->hashes.emplace_back(hash);
+		this->slots[slot] = symbol;
+
+		// keep the load factor under 1/2
+		if(this->strings.size() * 2 > this->slots.size()){
+			this->grow();
+		}
+
+		return symbol;
+	};
+
+
+	SymbolId Interner::find(std::string_view str) const {
+		auto hash = uint32_t(std::hash<std::string_view>{}(str));
+		return this->slots[this->find_slot(str, hash)];
+	};
+
+
+
+	uint Interner::find_slot(std::string_view str, uint32_t hash) const {
+		uint mask = uint(this->slots.size() - 1);
+		uint slot = hash & mask;
+
+		while(this->slots[slot] != none){
+			SymbolId symbol = this->slots[slot];
+			if(this->hashes[symbol] == hash && this->strings[symbol] == str){
+				break;
+			}
+
+			slot = (slot + 1) & mask;
+		}
+
+		return slot;
+	};
+
+
+	std::string_view Interner::store(std::string_view str){
+		if(this->block_used + str.size() > this->block_capacity){
+			this->block_capacity = std::max(block_size, str.size());
+			this->blocks.emplace_back(std::make_unique<char[]>(this->block_capacity));
+			this->block_used = 0;
+		}
+
+		char* dst = this->blocks.back().get() + this->block_used;
+		str.copy(dst, str.size());
+		this->block_used += str.size();
+
+		return std::string_view(dst, str.size());
+	};
+
+
+	void Interner::grow(){
+		this->slots.assign(this->slots.size() * 2, none);
+
+		uint mask = uint(this->slots.size() - 1);
+		for(SymbolId symbol = 0; symbol < this->strings.size(); symbol++){
+			uint slot = this->hashes[symbol] & mask;
+			while(this->slots[slot] != none){
+				slot = (slot + 1) & mask;
+			}
+			this->slots[slot] = symbol;
+		}
+	};
+
+
+
+	Interner& get_interner(){
+		static Interner interner{};
+		return interner;
+	};
+
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+
+namespace Hawk::symbols{
+
+	// dense id of an interned string (identifiers and type names)
+	// 	ids are handed out in order of first appearance, so they can index flat arrays
+	using SymbolId = uint32_t;
+
+	constexpr SymbolId none = ~SymbolId(0);
+
+	// interned by every Interner on construction (in this order)
+	constexpr SymbolId type_void   = 0;
+	constexpr SymbolId type_int    = 1;
+	constexpr SymbolId type_float  = 2;
+	constexpr SymbolId type_bool   = 3;
+	constexpr SymbolId func_printf = 4;
+
+
+
+	class Interner{
+		public:
+			Interner();
+			~Interner() = default;
+
+			Interner(const Interner&) = delete;
+			Interner& operator=(const Interner&) = delete;
+
+			SymbolId intern(std::string_view str);
+			SymbolId find(std::string_view str) const; // none if never interned
+
+			// the view stays valid for the lifetime of the interner
+			inline std::string_view get(SymbolId symbol) const { return this->strings[symbol]; };
+			inline size_t size() const { return this->strings.size(); };
+
+		private:
+			uint find_slot(std::string_view str, uint32_t hash) const;
+			std::string_view store(std::string_view str);
+			void grow();
+
+		private:
+			std::vector<std::string_view> strings;
+			std::vector<uint32_t> hashes;
+
+			// open addressing (linear probing), size is always a power of 2
+			std::vector<SymbolId> slots;
+
+			// interned strings are copied so they outlive the source buffers
+			std::vector<std::unique_ptr<char[]>> blocks;
+			size_t block_used = 0;
+			size_t block_capacity = 0;
+	};
+
+
+	// the interner shared by every compiler phase
+	Interner& get_interner();
+
+	inline SymbolId intern(std::string_view str){ return get_interner().intern(str); };
+	inline std::string_view get(SymbolId symbol){ return get_interner().get(symbol); };
+
+
+
+	// open addressing map keyed by SymbolId
+	// 	entries are kept in a dense array, so iteration is in insertion order
+	template<typename T>
+	class Map{
+		public:
+			struct Entry{
+				SymbolId symbol;
+				T value;
+			};
+
+		public:
+			Map() = default;
+			~Map() = default;
+
+
+			T* find(SymbolId symbol){
+				if(this->slots.empty()){ return nullptr; }
+
+				uint32_t index = this->slots[this->find_slot(symbol)];
+				if(index == empty){ return nullptr; }
+				return &this->entries[index].value;
+			};
+
+			const T* find(SymbolId symbol) const {
+				return const_cast<Map*>(this)->find(symbol);
+			};
+
+			inline bool contains(SymbolId symbol) const { return this->find(symbol) != nullptr; };
+
+
+			// inserts a default constructed value if not found
+			T& operator[](SymbolId symbol){
+				if((this->entries.size() + 1) * 2 > this->slots.size()){
+					this->grow();
+				}
+
+				uint slot = this->find_slot(symbol);
+				if(this->slots[slot] == empty){
+					this->slots[slot] = uint32_t(this->entries.size());
+					this->entries.emplace_back(symbol, T{});
+				}
+
+				return this->entries[this->slots[slot]].value;
+			};
+
+
+			void clear(){
+				this->slots.clear();
+				this->entries.clear();
+			};
+
+			inline size_t size() const { return this->entries.size(); };
+
+			inline auto begin(){ return this->entries.begin(); };
+			inline auto end(){ return this->entries.end(); };
+			inline auto begin() const { return this->entries.begin(); };
+			inline auto end() const { return this->entries.end(); };
+
+		private:
+			// ids are dense, so they hash to themselves (multiplying by an odd number only shuffles the low bits)
+			uint find_slot(SymbolId symbol) const {
+				uint mask = uint(this->slots.size() - 1);
+				uint slot = uint(symbol * 0x9E3779B1u) & mask;
+
+				while(this->slots[slot] != empty && this->entries[this->slots[slot]].symbol != symbol){
+					slot = (slot + 1) & mask;
+				}
+
+				return slot;
+			};
+
+			void grow(){
+				auto new_size = std::max<size_t>(8, this->slots.size() * 2);
+				this->slots.assign(new_size, empty);
+
+				for(uint32_t i = 0; i < this->entries.size(); i++){
+					this->slots[this->find_slot(this->entries[i].symbol)] = i;
+				}
+			};
+
+		private:
+			static constexpr uint32_t empty = ~uint32_t(0);
+
+			std::vector<uint32_t> slots;
+			std::vector<Entry> entries;
+	};
+
+
+
+	// nested scopes of names, one binding per SymbolId (the innermost one)
+	// 	ids are dense, so bindings are looked up by indexing an array, and leaving a scope puts back
+	// 	what the names in it shadowed from an undo log (only costs as much as the scope added)
+	template<typename T>
+	class ScopedMap{
+		public:
+			ScopedMap() = default;
+			~ScopedMap() = default;
+
+
+			void enter_scope(){
+				this->scope_starts.push_back(uint32_t(this->undo_log.size()));
+			};
+
+			void leave_scope(){
+				const uint32_t scope_start = this->scope_starts.back();
+				this->scope_starts.pop_back();
+
+				while(this->undo_log.size() > scope_start){
+					const auto& undo = this->undo_log.back();
+					this->bindings[undo.symbol] = undo.previous;
+					this->undo_log.pop_back();
+				};
+			};
+
+
+			// to the innermost scope
+			void add(SymbolId symbol, T value){
+				if(symbol >= this->bindings.size()){
+					this->bindings.resize(std::max<size_t>(symbol + 1, this->bindings.size() * 2));
+				}
+
+				auto& binding = this->bindings[symbol];
+				this->undo_log.emplace_back(symbol, binding);
+				binding = Binding{value, this->depth()};
+			};
+
+
+			const T* find(SymbolId symbol) const {
+				if(symbol >= this->bindings.size() || this->bindings[symbol].depth == 0){ return nullptr; }
+				return &this->bindings[symbol].value;
+			};
+
+			const T* find_in_current_scope(SymbolId symbol) const {
+				if(symbol >= this->bindings.size() || this->bindings[symbol].depth != this->depth()){ return nullptr; }
+				return &this->bindings[symbol].value;
+			};
+
+
+			// number of scopes entered (the global scope is 1)
+			inline uint32_t depth() const { return uint32_t(this->scope_starts.size()); };
+
+			void clear(){
+				this->bindings.clear();
+				this->undo_log.clear();
+				this->scope_starts.clear();
+			};
+
+		private:
+			struct Binding{
+				T value{};
+				uint32_t depth = 0; // 0 if not bound
+			};
+
+			struct Undo{
+				SymbolId symbol;
+				Binding previous;
+			};
+
+			std::vector<Binding> bindings;
+			std::vector<Undo> undo_log;
+			std::vector<uint32_t> scope_starts; // size of the undo log when each scope was entered
+	};
+
+}
+
+
+namespace Hawk{
+	using symbols::SymbolId;
+}
@@ -6,6 +6,8 @@
 #include "Parser.h"
 #include "SemanticAnalyzer.h"
 #include "Compiler.h"
+#include "ASTCache.h"
+#include "CompileServer.h"
 
 
 
@@ -13,22 +15,150 @@ namespace Hawk{
 
 
 
+	constexpr std::string_view version = "0.14.0";
+
 	void print_version(){
-		cmd::info("Hawk version: 0.12.1");
+		cmd::info("Hawk version: {}", version);
 	};
 	void print_help();
 
 
-	int main(std::vector<std::string>&& argv){
-		fs::path program_path = argv[0];
+	using Clock = std::chrono::steady_clock;
+
+	void print_phase_time(std::string_view phase, Clock::time_point start, size_t bytes = 0){
+		auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		if(bytes == 0){
+			cmd::log("{}: {:.3f} ms", phase, seconds * 1000.0);
+		}else{
+			cmd::log("{}: {:.3f} ms ({:.1f} MB/s)", phase, seconds * 1000.0, double(bytes) / seconds / (1024.0 * 1024.0));
+		}
+	};
+
 
+
+	// an input file and the tree the front end made from it
+	struct SourceFile{
 		fs::path path;
+		files::MappedFile file{};
+		std::unique_ptr<CharacterStream> char_stream{};
+
+		// when compiling for the compile server, the file (and its tree) are kept by it instead
+		ResidentFiles::File* resident = nullptr;
+
+		inline const CharacterStream& get_stream() const {
+			return this->resident != nullptr ? *this->resident->char_stream : *this->char_stream;
+		};
+
+		// only for files parsed on other threads (the shared interner isn't thread safe)
+		std::unique_ptr<symbols::Interner> interner{};
+
+		AST::Tree tree{};
+		std::string output{}; // printed by parse_file() on another thread
+		bool success = false;
+	};
+
+	struct FrontEndOptions{
+		bool print_tokens;
+		bool print_timing;
+		bool use_cache;
+		uint thread_count; // threads a single file can be lexed on
+	};
+
+
+	// lexes and parses a file into `source.tree` (or loads it from the AST cache), false on an error
+	bool parse_file(SourceFile& source, const FrontEndOptions& options, const ASTCache& ast_cache){
+		auto& char_stream = *source.char_stream;
+		auto& interner = source.interner != nullptr ? *source.interner : symbols::get_interner();
+		bool error_free = true;
+
+		auto instruction_set = simd::print_instruction_set(simd::get_scanner().instruction_set);
+
+		// big files are lexed up front on every core, otherwise the parser pulls tokens as it goes
+		// 	(the whole token list is also needed to print it)
+		bool lex_in_parallel = options.thread_count > 1 && char_stream.size() >= Tokenizer::parallel_chunk_size * 2;
+		bool stream_tokens = !options.print_tokens && !lex_in_parallel;
+
+		auto tokenizer = Tokenizer(char_stream, interner);
+		auto parser = stream_tokens ? Parser(tokenizer) : Parser(tokenizer.tokens, char_stream);
+		auto phase_start = Clock::now();
+
+		// the tokens aren't kept in the cache, so they can't be printed from it
+		bool loaded_from_cache = options.use_cache && !options.print_tokens && ast_cache.load(char_stream.get_file(), parser.tree, interner);
+
+		if(loaded_from_cache){
+			if(options.print_timing){
+				print_phase_time("AST cache (load)", phase_start, char_stream.size());
+			}
+
+		}else if(stream_tokens){
+			parser.start();
+			if(options.print_timing){
+				print_phase_time(fmt::format("Tokenizer + Parser [{}]", instruction_set), phase_start, char_stream.size());
+			}
+			error_free = tokenizer.success() && parser.success();
+
+		}else{
+			tokenizer.start_parallel(options.thread_count);
+			if(options.print_timing){
+				print_phase_time(fmt::format("Tokenizer [{}, {} threads]", instruction_set, options.thread_count), phase_start, char_stream.size());
+			}
+			error_free = tokenizer.success();
+
+			if(error_free){
+				if(options.print_tokens){
+					cmd::info("\nTokens:");
+					cmd::log("-------------------------------");
+					for(uint i = 0; i < tokenizer.tokens.size(); i++){
+						cmd::print("token: {}", tokenizer.tokens.get(i).value);
+					}
+					cmd::log("-------------------------------\n");
+				}
+
+				phase_start = Clock::now();
+				parser.start();
+				if(options.print_timing){ print_phase_time("Parser", phase_start); }
+				error_free = parser.success();
+			}
+		}
+
+		if(options.use_cache && !loaded_from_cache && error_free){
+			phase_start = Clock::now();
+			if(!ast_cache.save(char_stream.get_file(), parser.tree)){
+				cmd::warning("unable to write to the AST cache \"{}\"", ast_cache.get_directory());
+			}
+			if(options.print_timing){ print_phase_time("AST cache (save)", phase_start); }
+		}
+
+		source.tree = std::move(parser.tree);
+		return error_free;
+	};
+
+
+	// `resident_files` is only given by the compile server
+	int main(std::vector<std::string>&& argv, ResidentFiles* resident_files = nullptr){
+		fs::path program_path = argv[0];
+
+		auto paths = std::vector<fs::path>();
 		// fs::path path = program_path.parent_path() / "../../../tests/test.hawk";
 
 		bool print_feedback = false;
 		bool print_tokens = false;
 		bool print_ast = false;
 		bool print_ir = false;
+		bool print_timing = false;
+
+		bool use_cache = false;
+		fs::path cache_directory = ".hawkcache";
+
+		uint max_errors = 0;
+		uint max_warnings = 0;
+		uint thread_count = 0; // every core
+
+		bool run_server = false;
+		bool run_client = false;
+		fs::path socket_path = CompileServer::get_default_socket_path();
+		auto client_args = std::vector<std::string>();
 
 		enum class OutputMode{
 			assembly,
@@ -42,88 +172,264 @@ namespace Hawk{
 
 
 
-		if(argv.size() > 1){
-			for(int i = 1; i < argv.size(); i++){
-				auto arg = argv[i];
+		for(int i = 1; i < argv.size(); i++){
+			auto arg = argv[i];
+
+
+				  if(arg == "-c=asm"){  output_mode = OutputMode::assembly;
+			}else if(arg == "-c=exe"){	output_mode = OutputMode::exe; //default
+			}else if(arg == "-c=int"){	output_mode = OutputMode::interpret;
+			}else if(arg == "-c=llvm"){	output_mode = OutputMode::llvm;
+			}else if(arg == "-c=o"){	output_mode = OutputMode::object;
 
+			}else if(arg == "-h"){		print_help(); return 0;
+			}else if(arg == "-v"){		print_version(); return 0;
 
-					  if(arg == "-c=asm"){  output_mode = OutputMode::assembly;
-				}else if(arg == "-c=exe"){	output_mode = OutputMode::exe; //default
-				}else if(arg == "-c=int"){	output_mode = OutputMode::interpret;
-				}else if(arg == "-c=llvm"){	output_mode = OutputMode::llvm;
-				}else if(arg == "-c=o"){	output_mode = OutputMode::object;
+			}else if(arg == "-f"){		print_feedback = true;
+			}else if(arg == "-nc"){	 	cmd::use_no_color();
 
-				}else if(arg == "-h"){		print_help(); return 0;
-				}else if(arg == "-v"){		print_version(); return 0;
+			}else if(arg == "-ast"){	print_ast = true;
+			}else if(arg == "-ir"){     print_ir = true;
+			}else if(arg == "-tokens"){ print_tokens = true;
+			}else if(arg == "-time"){   print_timing = true;
 
-				}else if(arg == "-f"){		print_feedback = true;
-				}else if(arg == "-nc"){	 	cmd::use_no_color();
+			}else if(arg == "-cache"){  use_cache = true;
+			}else if(arg.starts_with("-cache=")){
+				use_cache = true;
+				cache_directory = arg.substr(std::string_view("-cache=").size());
 
-				}else if(arg == "-ast"){	print_ast = true;
-				}else if(arg == "-ir"){     print_ir = true;
-				}else if(arg == "-tokens"){ print_tokens = true;
+			}else if(arg.starts_with("-max-errors=") || arg.starts_with("-max-warnings=") || arg.starts_with("-threads=")){
+				auto value = std::string_view(arg).substr(arg.find('=') + 1);
+				uint& number = arg.starts_with("-max-errors=") ? max_errors : arg.starts_with("-max-warnings=") ? max_warnings : thread_count;
 
-				}else if(i != 1){
-					cmd::error("Unknown arg: {}", arg);
+				if(auto result = std::from_chars(value.data(), value.data() + value.size(), number); result.ec != std::errc() || result.ptr != value.data() + value.size()){
+					cmd::error("Invalid arg: {}", arg);
 					return -1;
 				}
 
+			}else if(arg == "-server" || arg.starts_with("-server=")){
+				run_server = true;
+				if(arg.size() > std::string_view("-server").size()){ socket_path = arg.substr(std::string_view("-server=").size()); }
+				continue;
+
+			}else if(arg == "-client" || arg.starts_with("-client=")){
+				run_client = true;
+				if(arg.size() > std::string_view("-client").size()){ socket_path = arg.substr(std::string_view("-client=").size()); }
+				continue;
+
+			}else if(arg == "-stop"){
+				// only for -client
+
+			}else if(arg.starts_with("-")){
+				cmd::error("Unknown arg: {}", arg);
+				return -1;
+
+			}else{
+				paths.emplace_back(arg);
 			}
 
-			path = argv[1];
-		}else{
+			client_args.emplace_back(arg);
+		}
+
+
+		if((run_server || run_client) && resident_files != nullptr){
+			cmd::error("-server and -client can't be sent to a compile server");
+			return -1;
+
+		}else if(run_server){
+			auto server = CompileServer(socket_path, fs::absolute(program_path).string(), [](std::vector<std::string>&& argv, ResidentFiles& resident_files){
+				return Hawk::main(std::move(argv), &resident_files);
+			});
+			return server.run();
+
+		}else if(run_client){
+			// the flags are parsed again by the server (relative paths are from this working directory)
+			return CompileServer::run_client(socket_path, client_args);
+
+		}else if(std::ranges::find(argv, "-stop") != argv.end()){
+			cmd::error("-stop is only for -client");
+			return -1;
+		}
+
+		if(paths.empty()){
 			cmd::error("No target file given");
 			return -1;
 		}
 
-		if(!fs::exists(path)){
-			cmd::error("file \"{}\" does not exist", path);
-			return -1;	
+		// the compile server keeps the trees itself (the AST cache and the token list aren't used)
+		bool use_resident_files = resident_files != nullptr && !print_tokens;
+
+		auto sources = std::vector<std::unique_ptr<SourceFile>>();
+		for(const auto& path : paths){
+			if(!fs::exists(path)){
+				cmd::error("file \"{}\" does not exist", path);
+				return -1;	
+			}
+
+			auto& source = *sources.emplace_back(std::make_unique<SourceFile>(path));
+			if(use_resident_files){ continue; }
+
+			if(!source.file.open(path)){
+				cmd::error("unable to read file \"{}\"", path);
+				return -1;
+			}
+
+			source.char_stream = std::make_unique<CharacterStream>(source.file.view());
 		}
 
 
-		std::string file = files::read(path);
 		bool error_free = true;
 
-		auto char_stream = CharacterStream(file);
+		auto instruction_set = simd::print_instruction_set(simd::get_scanner().instruction_set);
+		if(thread_count == 0){ thread_count = std::max(std::thread::hardware_concurrency(), 1u); }
+		auto ast_cache = ASTCache(cache_directory, version);
+		auto phase_start = Clock::now();
 
-		auto tokenizer = Tokenizer(char_stream);
-		tokenizer.start();
-		error_free = tokenizer.success();
+		// the tree of every file is merged into one (a single file's is used as is)
+		auto merged_tree = AST::Tree();
+		AST::Tree* tree = &merged_tree;
 
+		// hash of the source of every top level statement, the compile server matches declarations to the last compile with it
+		auto statement_hashes = std::vector<size_t>();
 
-		auto parser = Parser(tokenizer.tokens);
-		if(error_free){
+		if(use_resident_files){
+			for(auto& source : sources){
+				source->resident = resident_files->load(source->path);
+				if(source->resident == nullptr){
+					cmd::error("unable to read file \"{}\"", source->path);
+					return -1;
+				}
 
-			if(print_tokens){
-				cmd::info("\nTokens:");
-				cmd::log("-------------------------------");
-				for(auto& token : tokenizer.tokens){
-					cmd::print("token: {}", token.value);
+				error_free = error_free && source->resident->parser->success();
+			}
+
+			if(print_timing){
+				print_phase_time(fmt::format("Tokenizer + Parser [{}, resident]", instruction_set), phase_start);
+			}
+
+			// the resident trees are kept for the next compile, so they're copied
+			// 	(their names are already in the shared interner)
+			if(error_free){
+				phase_start = Clock::now();
+
+				auto symbol_map = std::vector<SymbolId>(symbols::get_interner().size());
+				std::iota(symbol_map.begin(), symbol_map.end(), SymbolId(0));
+
+				for(const auto& source : sources){
+					const auto& parser = *source->resident->parser;
+					merged_tree.append(parser.tree, symbol_map);
+
+					for(size_t i = 0; i < parser.tree.statements.size(); i++){
+						statement_hashes.push_back(std::hash<std::string_view>()(parser.get_statement_source(i)));
+					}
 				}
-				cmd::log("-------------------------------\n");
+
+				if(print_timing){ print_phase_time("Merge", phase_start); }
 			}
 
+		}else if(sources.size() == 1){
+			error_free = parse_file(*sources[0], FrontEndOptions(print_tokens, print_timing, use_cache, thread_count), ast_cache);
+			tree = &sources[0]->tree;
 
-			parser.start();
-			error_free = parser.success();
+		}else{
+			// one file per thread, each with its own interner and output buffer
+			auto options = FrontEndOptions(print_tokens, false, use_cache, 1);
+			phase_start = Clock::now();
+
+			auto next_file = std::atomic<size_t>(0);
+			auto parse_files = [&](){
+				for(size_t i = next_file++; i < sources.size(); i = next_file++){
+					auto& source = *sources[i];
+					source.interner = std::make_unique<symbols::Interner>();
+
+					cmd::capture_output(&source.output);
+					source.success = parse_file(source, options, ast_cache);
+					cmd::capture_output(nullptr);
+				}
+			};
+
+			auto threads = std::vector<std::thread>();
+			for(size_t i = 1; i < std::min<size_t>(thread_count, sources.size()); i++){
+				threads.emplace_back(parse_files);
+			}
+			parse_files();
+
+			for(auto& thread : threads){
+				thread.join();
+			}
+
+
+			size_t total_size = 0;
+			for(const auto& source : sources){
+				if(!source->output.empty()){
+					cmd::info("\n{}:", source->path.string());
+					cmd::out(source->output.c_str());
+				}
+
+				error_free = error_free && source->success;
+				total_size += source->char_stream->size();
+			}
+
+			if(print_timing){
+				print_phase_time(fmt::format("Tokenizer + Parser [{}, {} files, {} threads]", instruction_set, sources.size(), threads.size() + 1), phase_start, total_size);
+			}
+
+
+			// names are interned into the shared interner file by file, so the ids are the same on every run
+			if(error_free){
+				phase_start = Clock::now();
+
+				auto& interner = symbols::get_interner();
+				auto symbol_map = std::vector<SymbolId>();
+
+				for(auto& source : sources){
+					symbol_map.resize(source->interner->size());
+					for(SymbolId symbol = 0; symbol < symbol_map.size(); symbol++){
+						symbol_map[symbol] = interner.intern(source->interner->get(symbol));
+					}
+
+					merged_tree.append(source->tree, symbol_map);
+					source->tree = AST::Tree();
+				}
+
+				if(print_timing){ print_phase_time("Merge", phase_start); }
+			}
 		}
 
 
+		// in the same order as the trees were merged
+		auto source_files = SourceFiles();
+		for(const auto& source : sources){
+			source_files.add(source->path, source->get_stream());
+		}
+
+
+
+		auto diagnostics = Diagnostics(source_files);
+		diagnostics.set_limits(max_errors, max_warnings);
+
+		auto semantic_analyzer = SemanticAnalyzer(*tree, source_files, diagnostics, thread_count);
+		if(use_resident_files){
+			semantic_analyzer.use_signatures(resident_files->signatures, statement_hashes);
+		}
 
-		auto semantic_analyzer = SemanticAnalyzer(parser.statements);
 		if(error_free){
 
 			if(print_ast){
 				cmd::info("\nAST:");
 				cmd::log("-------------------------------");
-				for(auto* stmt : parser.statements){
-					stmt->print(0);
+				for(auto stmt : tree->statements){
+					tree->print(stmt, 0);
 				}
 				cmd::log("-------------------------------\n");
 			}
 
+			phase_start = Clock::now();
 			semantic_analyzer.begin();
+			diagnostics.print();
+			if(print_timing){
+				print_phase_time(use_resident_files ? fmt::format("SemanticAnalyzer [{} return types kept]", semantic_analyzer.get_kept_return_types()) : "SemanticAnalyzer", phase_start);
+			}
 			error_free = semantic_analyzer.get_error_count() == 0;
 			bool warning_free = semantic_analyzer.get_warning_count() == 0;
 
@@ -136,8 +442,10 @@ namespace Hawk{
 
 
 		if(error_free){
-			auto compiler = Compiler(semantic_analyzer.global_vars, semantic_analyzer.functions, "hawk_module");
+			auto compiler = Compiler(*tree, semantic_analyzer.global_vars, semantic_analyzer.functions, semantic_analyzer.types, semantic_analyzer.const_evaluator, "hawk_module");
+			phase_start = Clock::now();
 			compiler.build_ir();
+			if(print_timing){ print_phase_time("Compiler (IR)", phase_start); }
 			compiler.save_ir_to_file();
 
 
@@ -195,7 +503,7 @@ namespace Hawk{
 		cmd::info("Hawk help:");
 
 		cmd::info("\n\tgeneral usage:");
-		cmd::print("\t\thawk [path/to/file.hawk] [-flags...]");
+		cmd::print("\t\thawk [path/to/file.hawk...] [-flags...]");
 
 		cmd::info("\n\n\tfunctions:");
 
@@ -214,11 +522,24 @@ namespace Hawk{
 		cmd::info("\n\n\tflags:");
 		  cmd::print("\t\t-f:    print feedback at the end of compilation (success / fail)");
 		  cmd::print("\t\t-nc:   logs without color. If \"-nc\" is put before \"-h\", the help menu will also not be in color");
+		  cmd::print("\t\t-cache:       reuse the AST of unchanged files (kept in ./.hawkcache)");
+		  cmd::print("\t\t-cache=[dir]: same as -cache, but kept in [dir]");
+		  cmd::print("\t\t-max-errors=[n]:   only show the first [n] errors (the rest are still counted)");
+		  cmd::print("\t\t-max-warnings=[n]: only show the first [n] warnings (the rest are still counted)");
+		  cmd::print("\t\t-threads=[n]:      lex, parse and analyze on [n] threads (default: one for every core)");
+
+		cmd::info("\n\n\tcompile server:");
+		cmd::print("\t\t-server:        keep running and compile what hawk -client sends (keeps the parsed files between compiles)");
+		cmd::print("\t\t-server=[path]: same as -server, on the socket at [path] instead of the default one");
+		cmd::print("\t\t-client:        send the compilation (the path and the rest of the flags) to the compile server");
+		cmd::print("\t\t-client=[path]: same as -client, to the server on the socket at [path]");
+		cmd::print("\t\t-stop:          with -client, stop the compile server");
 
 		cmd::info("\n\n\tdebug:");
 		cmd::print("\t\t-ast:	 show the AST (Abstract Syntax Tree)");
 		cmd::print("\t\t-ir:     show the llvm IR (Intermediate Representation)");
 		cmd::print("\t\t-tokens: show the program tokens");
+		cmd::print("\t\t-time:   show how long each compilation phase took");
 
 		cmd::print("\n");
 	};
@@ -11,6 +11,7 @@
 #include <stack>
 #include <queue>
 #include <array>
+#include <memory>
 #include <span>
 #include <set>
 
@@ -18,9 +19,13 @@
 #include <regex>
 #include <filesystem>
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <variant>
 #include <inttypes.h>
 #include <bitset>
+#include <bit>
+#include <chrono>
 
 
 // functionality
@@ -28,6 +33,8 @@
 #include <mutex>
 #include <future>
 #include <functional>
+#include <numeric>
+#include <cstring>
 #include <xhash>
 
 
@@ -42,6 +49,9 @@ using uint = unsigned int;
 #include "./core/fmt.h"
 #include "./core/cmd.h"
 #include "./core/files.h"
+#include "./core/simd.h"
+#include "./core/symbols.h"
+#include "./core/sockets.h"
 
 
 
@@ -0,0 +1,159 @@
+# compiles generated programs with 100k-term expressions and 10k-deep conditionals (else if chains and nested ifs)
+# and runs them (the IR is built with llc and linked with cc), the parser, SemanticAnalyzer, ConstEvaluator and Compiler walk them without recursion
+# 	hawk runs with a 1MB stack, so a walk that recurses once per term or level overflows it
+# 	every program checks its function on a global (compiled) and on a constant (folded), main returns 3 if both are right
+#
+# usage: python3 tests/deep_nesting.py path/to/hawk [path/to/llc]
+
+import os
+import random
+import resource
+import subprocess
+import sys
+import tempfile
+
+
+
+TERMS = 100_000
+DEPTH = 10_000
+
+
+def check_main(function, argument, expected):
+	return "\n".join([
+		f"n : int = {argument};",
+		"",
+		"func main() int {",
+		"\tr : int = 0;",
+		f"\tif ({function}(n) == {expected}) {{ r = r + 1; }};",
+		f"\tif ({function}({argument}) == {expected}) {{ r = r + 2; }};",
+		"\treturn r;",
+		"};",
+	]) + "\n"
+
+
+# a + 3 - a * 2 + ... (* binds tighter, the rest is left to right)
+def long_expression(rng):
+	terms = ["a"]
+	value = 5
+	total = value
+
+	for _ in range(TERMS - 1):
+		op = rng.choice(["+", "-", "+ 2 *"])
+		operand = rng.choice(["a", str(rng.randrange(10))])
+		number = value if operand == "a" else int(operand)
+
+		if op == "+":
+			total += number
+		elif op == "-":
+			total -= number
+		else:
+			total += 2 * number
+		terms.append(f"{op} {operand}")
+
+	source = "func f(a: int) int {\n\treturn " + " ".join(terms) + ";\n};\n\n"
+	return source + check_main("f", value, total)
+
+
+# a > 0 && a < 10 && ... as the condition of an if
+def long_condition(rng):
+	value = 5
+	terms = []
+	for _ in range(TERMS // 2):
+		terms.append(rng.choice(["a > 0", "a < 10", "a == 5", "a != 7"]))
+
+	source = "func f(a: int) int {\n\tif (" + " && ".join(terms) + ") { return 1; };\n\treturn 0;\n};\n\n"
+	return source + check_main("f", value, 1)
+
+
+def else_if_chain(rng):
+	value = rng.randrange(DEPTH)
+	lines = ["func f(x: int) int {", "\ts : int = 0;"]
+
+	arms = [f"if (x == {i}) {{ s = {i * 3}; }}" for i in range(DEPTH)]
+	lines.append("\t" + " else ".join(arms) + " else { s = 1; };")
+	lines += ["\treturn s;", "};", ""]
+
+	return "\n".join(lines) + "\n" + check_main("f", value, value * 3)
+
+
+def nested_ifs(rng):
+	value = rng.randrange(DEPTH)
+	lines = ["func f(x: int) int {", "\ts : int = 0;"]
+
+	lines += [f"{chr(9) * (i % 8 + 1)}if (x > {i}) {{ s = s + 1;" for i in range(DEPTH)]
+	lines.append("\t" + "};" * DEPTH)
+	lines += ["\treturn s;", "};", ""]
+
+	return "\n".join(lines) + "\n" + check_main("f", value, value)
+
+
+
+def limit_stack():
+	resource.setrlimit(resource.RLIMIT_STACK, (1 << 20, 1 << 20))
+
+
+def main():
+	if len(sys.argv) < 2:
+		print("usage: python3 tests/deep_nesting.py path/to/hawk [path/to/llc]")
+		return 2
+
+	hawk = os.path.abspath(sys.argv[1])
+	llc = sys.argv[2] if len(sys.argv) > 2 else "llc"
+	rng = random.Random(1)
+
+	cases = [
+		("100k-term expression", long_expression),
+		("50k-term condition", long_condition),
+		("10k else if chain", else_if_chain),
+		("10k nested ifs", nested_ifs),
+	]
+
+	failures = 0
+
+	with tempfile.TemporaryDirectory() as root:
+		for name, make in cases:
+			with open(os.path.join(root, "deep.hawk"), "w") as file:
+				file.write(make(rng))
+
+			output_path = os.path.join(root, "output.ll")
+			if os.path.exists(output_path):
+				os.remove(output_path)
+
+			compiled = subprocess.run([hawk, "deep.hawk", "-nc", "-c=llvm"], cwd = root, capture_output = True, text = True, timeout = 600, preexec_fn = limit_stack)
+			if compiled.returncode != 0 or not os.path.exists(output_path):
+				failures += 1
+				print(f"{name}: didn't compile (exit code {compiled.returncode})")
+				print("\t" + compiled.stdout[-500:].replace("\n", "\n\t"))
+				continue
+
+			# lli's JIT takes minutes on a 100k instruction function, llc -O0 takes a second
+			executable_path = os.path.join(root, "deep")
+			built = subprocess.run([llc, "-O0", "-filetype=obj", "-relocation-model=pic", output_path, "-o", executable_path + ".o"], capture_output = True, text = True, timeout = 600)
+			if built.returncode == 0:
+				built = subprocess.run(["cc", executable_path + ".o", "-o", executable_path], capture_output = True, text = True, timeout = 600)
+			if built.returncode != 0:
+				failures += 1
+				print(f"{name}: the IR didn't build")
+				print("\t" + built.stderr[-500:].replace("\n", "\n\t"))
+				continue
+
+			ran = subprocess.run([executable_path], cwd = root, capture_output = True, timeout = 600)
+			if ran.returncode != 3:
+				failures += 1
+				print(f"{name}: main returned {ran.returncode} (3 if the compiled and the folded call are right)")
+				continue
+
+			print(f"{name}: ok")
+
+
+	if failures != 0:
+		print("FAILED")
+		return 1
+
+	print("passed")
+	return 0
+
+
+
+if __name__ == "__main__":
+	sys.exit(main())
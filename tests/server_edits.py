@@ -0,0 +1,255 @@
+# edits a file between compiles of the compile server (hawk -server) and checks that every compile
+# gives the same exit code, output and IR (-c=llvm) as running hawk on the file directly
+# 	the edits add, remove and change lines, functions and globals, and now and then break the file
+# 	functions without a written return type return an int, a float or what another function returns,
+# 	so the return types the server keeps between compiles have to change with them
+#
+# usage: python3 tests/server_edits.py path/to/hawk [edit count] [seed]
+
+import os
+import random
+import subprocess
+import sys
+import tempfile
+import time
+
+
+
+class Program:
+	def __init__(self, rng):
+		self.rng = rng
+		self.next_name = 0
+		self.globals = []   # [name, value]
+		self.functions = [] # {name, written, body: [line], ret}
+
+		for _ in range(4):
+			self.add_global()
+		for _ in range(8):
+			self.add_function()
+
+
+	def new_name(self, prefix):
+		self.next_name += 1
+		return f"{prefix}{self.next_name}"
+
+
+	def expr(self):
+		choice = self.rng.randrange(6)
+		if choice == 0 and len(self.functions) > 0:
+			function = self.rng.choice(self.functions)
+			return f"{function['name']}({self.arg()}, {self.arg()})"
+		if choice == 1 and len(self.globals) > 0:
+			return self.rng.choice(self.globals)[0]
+		if choice == 2:
+			return "a"
+		if choice == 3:
+			return "b"
+		return str(self.rng.randrange(10))
+
+	# only names that are never removed (the SemanticAnalyzer doesn't check the arguments of a call inside an expression yet)
+	def arg(self):
+		return self.rng.choice(["a", "b", str(self.rng.randrange(10))])
+
+	def const_expr(self):
+		if self.rng.randrange(3) == 0 and len(self.functions) > 0:
+			return f"{self.rng.choice(self.functions)['name']}({self.rng.randrange(10)}, {self.rng.randrange(10)})"
+		return str(self.rng.randrange(100))
+
+	def ret(self):
+		choice = self.rng.randrange(6)
+		if choice == 0:
+			return "0.5"
+		if choice == 1 and len(self.functions) > 0:
+			return f"{self.rng.choice(self.functions)['name']}({self.arg()}, {self.arg()})"
+		if choice == 2:
+			return f"s + {self.expr()}"
+		return "s"
+
+	def line(self):
+		if self.rng.randrange(4) == 0:
+			return f"if (s > {self.rng.randrange(20)}) {{ s = s - {self.expr()}; }};"
+		return f"s = s + {self.expr()};"
+
+
+	def add_global(self):
+		self.globals.insert(self.rng.randrange(len(self.globals) + 1), [self.new_name("g"), str(self.rng.randrange(100))])
+
+	def add_function(self):
+		function = {
+			"name": self.new_name("f"),
+			"written": self.rng.randrange(2) == 0,
+			"body": [],
+			"ret": "s",
+		}
+		# only calls to functions that already exist, so there's no recursion
+		function["body"] = [self.line() for _ in range(self.rng.randrange(1, 5))]
+		self.functions.insert(self.rng.randrange(len(self.functions) + 1), function)
+
+
+	def mutate(self):
+		choice = self.rng.randrange(10)
+		function = self.rng.choice(self.functions)
+
+		if choice == 0 and len(function["body"]) > 0:
+			del function["body"][self.rng.randrange(len(function["body"]))]
+		elif choice == 1:
+			function["body"].insert(self.rng.randrange(len(function["body"]) + 1), self.line())
+		elif choice == 2:
+			function["written"] = not function["written"]
+		elif choice == 3 and len(self.functions) > 1:
+			# calls to it are left behind (an error until they're gone)
+			self.functions.remove(function)
+		elif choice == 4:
+			self.add_function()
+		elif choice == 5 and len(self.globals) > 1:
+			del self.globals[self.rng.randrange(len(self.globals))]
+		elif choice == 6:
+			self.add_global()
+		elif choice == 7:
+			self.rng.choice(self.globals)[1] = self.const_expr()
+		else:
+			function["ret"] = self.ret()
+
+
+	def remove_broken_calls(self):
+		names = {function["name"] for function in self.functions} | {name for name, _ in self.globals}
+
+		def is_valid(text):
+			return all(word in names or not (word.startswith("f") or word.startswith("g")) for word in
+				"".join(char if char.isalnum() else " " for char in text).split())
+
+		for function in self.functions:
+			function["body"] = [line for line in function["body"] if is_valid(line)]
+			if not is_valid(function["ret"]):
+				function["ret"] = "s"
+
+		for value in self.globals:
+			if not is_valid(value[1]):
+				value[1] = "0"
+
+
+	def render(self):
+		lines = [f"{name} : int = {value};" for name, value in self.globals]
+		lines.append("")
+
+		for function in self.functions:
+			lines.append(f"func {function['name']}(a: int, b: int){' int' if function['written'] else ''} {{")
+			lines.append("\ts : int = a + b;")
+			lines += ["\t" + line for line in function["body"]]
+			lines.append(f"\treturn {function['ret']};")
+			lines.append("};")
+			lines.append("")
+
+		lines.append("func main() int {")
+		lines.append("\tt : int = 0;")
+		# calls as statements, a function can lose its return (and a void variable crashes the SemanticAnalyzer)
+		for function in self.functions:
+			lines.append(f"\t{function['name']}(t, 1);")
+		lines.append("\treturn t;")
+		lines.append("};")
+		return "\n".join(lines) + "\n"
+
+
+
+def run(hawk, args, directory):
+	output_path = os.path.join(directory, "output.ll")
+	if os.path.exists(output_path):
+		os.remove(output_path)
+
+	result = subprocess.run([hawk] + args, cwd = directory, capture_output = True, text = True, timeout = 60)
+
+	ir = None
+	if os.path.exists(output_path):
+		with open(output_path) as file:
+			ir = file.read()
+
+	return result.returncode, result.stdout, ir
+
+
+def write(directory, source):
+	with open(os.path.join(directory, "edit.hawk"), "w") as file:
+		file.write(source)
+
+
+
+def main():
+	if len(sys.argv) < 2:
+		print("usage: python3 tests/server_edits.py path/to/hawk [edit count] [seed]")
+		return 2
+
+	hawk = os.path.abspath(sys.argv[1])
+	edit_count = int(sys.argv[2]) if len(sys.argv) > 2 else 300
+	seed = int(sys.argv[3]) if len(sys.argv) > 3 else 1
+
+	rng = random.Random(seed)
+	program = Program(rng)
+
+	with tempfile.TemporaryDirectory() as root:
+		server_directory = os.path.join(root, "server")
+		direct_directory = os.path.join(root, "direct")
+		os.mkdir(server_directory)
+		os.mkdir(direct_directory)
+
+		socket_path = os.path.join(root, "hawk.sock")
+		server = subprocess.Popen([hawk, f"-server={socket_path}", "-nc"], stdout = subprocess.DEVNULL, stderr = subprocess.DEVNULL)
+
+		for _ in range(100):
+			if os.path.exists(socket_path):
+				break
+			time.sleep(0.05)
+
+		failures = 0
+
+		try:
+			source = program.render()
+
+			for edit in range(edit_count + 1):
+				write(server_directory, source)
+				write(direct_directory, source)
+
+				from_server = run(hawk, [f"-client={socket_path}", "edit.hawk", "-nc", "-c=llvm"], server_directory)
+				direct = run(hawk, ["edit.hawk", "-nc", "-c=llvm"], direct_directory)
+
+				if from_server != direct:
+					failures += 1
+					print(f"edit {edit}: the server and a direct run differ")
+					print(f"\tserver: exit code {from_server[0]}, {from_server[1]!r}")
+					print(f"\tdirect: exit code {direct[0]}, {direct[1]!r}")
+					if from_server[2] != direct[2]:
+						print("\tthe IR differs")
+
+					if failures == 5:
+						break
+
+
+				# most edits are to the program, some only break the file (the next edit puts it back)
+				if rng.randrange(8) == 0:
+					lines = source.split("\n")
+					start = rng.randrange(len(lines))
+					del lines[start:start + rng.randrange(1, 4)]
+					source = "\n".join(lines)
+					continue
+
+				for _ in range(rng.randrange(1, 3)):
+					program.mutate()
+				if rng.randrange(3) != 0:
+					program.remove_broken_calls()
+
+				source = program.render()
+
+		finally:
+			subprocess.run([hawk, f"-client={socket_path}", "-stop"], capture_output = True)
+			server.wait(timeout = 10)
+
+
+	if failures != 0:
+		print("FAILED")
+		return 1
+
+	print(f"passed ({edit_count} edits)")
+	return 0
+
+
+
+if __name__ == "__main__":
+	sys.exit(main())
@@ -0,0 +1,193 @@
+# lexes big generated files on one thread (Tokenizer::start()) and on several (Tokenizer::start_parallel(), files of 8MB and up)
+# and checks that both give the same exit code, tokens (-tokens) and IR (-c=llvm)
+# 	the files put comments, nested block comments and errors where the chunks get split
+#
+# usage: python3 tests/tokenizer_chunks.py path/to/hawk [seed]
+
+import hashlib
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+
+
+MB = 1 << 20
+
+
+class Source:
+	def __init__(self, rng):
+		self.rng = rng
+		self.parts = []
+		self.size = 0
+		self.function_count = 0
+
+
+	def add(self, text):
+		self.parts.append(text)
+		self.size += len(text)
+
+
+	def comment(self):
+		choice = self.rng.randrange(8)
+		if choice == 0:
+			return "// a line comment with / and /* and */ in it\n"
+		if choice == 1:
+			return "/* a block comment */ "
+		if choice == 2:
+			return "/* a block\n\tcomment over\n\tlines */\n"
+		if choice == 3:
+			return "/* nested /* block\n comments */ still a comment\n */\n"
+		if choice == 4:
+			return "/** stars ***/ "
+		if choice == 5:
+			return "/*/ not closed yet */ "
+		if choice == 6:
+			return "//\n"
+		return ""
+
+
+	def function(self, comments):
+		self.function_count += 1
+		name = f"f{self.function_count}"
+
+		lines = [f"func {name}(a: int, b: int) int {{"]
+		lines.append("\ts : int = a + b;")
+		for _ in range(self.rng.randrange(1, 6)):
+			line = f"\ts = s + a * {self.rng.randrange(100)} / b;"
+			if comments:
+				line = self.comment() + line
+			lines.append(line)
+		lines.append("\treturn s;")
+		lines.append("};")
+		return "\n".join(lines) + "\n\n"
+
+
+	def code(self, size, comments = False):
+		end = self.size + size
+		while self.size < end:
+			self.add(self.function(comments))
+
+
+	# one comment spanning `size` bytes of lines, with comments nested in it
+	def big_comment(self, size):
+		self.add("/* a big comment\n")
+		end = self.size + size
+		depth = 1
+		while self.size < end:
+			choice = self.rng.randrange(10)
+			if choice == 0:
+				self.add("/* nested\n")
+				depth += 1
+			elif choice == 1 and depth > 1:
+				self.add("nested end */\n")
+				depth -= 1
+			else:
+				self.add(f"func g(a: int) int {{ // not code\n\treturn a / 2; }};\n")
+		self.add(" */\n" * depth)
+
+
+	def main(self):
+		self.add("func main() int {\n\tt : int = 0;\n")
+		self.add(f"\tt = t + f{self.function_count}(t, 1);\n")
+		self.add("\treturn t;\n};\n")
+
+
+	def write(self, path):
+		with open(path, "w") as file:
+			file.write("".join(self.parts))
+
+
+
+def make_cases(rng):
+	cases = []
+
+	source = Source(rng)
+	source.code(9 * MB)
+	source.main()
+	cases.append(("code", source))
+
+	source = Source(rng)
+	source.code(17 * MB, comments = True)
+	source.main()
+	cases.append(("comments", source))
+
+	# the split targets (every 1/4th of the file) land inside the big comments
+	source = Source(rng)
+	for _ in range(4):
+		source.code(2 * MB, comments = True)
+		source.big_comment(2 * MB)
+	source.main()
+	cases.append(("big comments", source))
+
+	# somewhere past the first chunk, in files big enough to be split
+	for error, text in (("bad char", "\t$\n"), ("null char", "\0"), ("unterminated comment", "/* /* never closed */\n")):
+		source = Source(rng)
+		before = rng.randrange(5, 15) * MB
+		source.code(before, comments = True)
+		source.add(text)
+		source.code(max(9 * MB - before, 0) + rng.randrange(1, 4) * MB, comments = True)
+		source.main()
+		cases.append((error, source))
+
+	return cases
+
+
+
+def run(hawk, path, threads):
+	directory = os.path.dirname(path)
+	output_path = os.path.join(directory, "output.ll")
+	if os.path.exists(output_path):
+		os.remove(output_path)
+
+	result = subprocess.run([hawk, os.path.basename(path), "-nc", "-tokens", "-c=llvm", f"-threads={threads}"], cwd = directory, capture_output = True, timeout = 600)
+
+	ir = None
+	if os.path.exists(output_path):
+		with open(output_path, "rb") as file:
+			ir = hashlib.sha256(file.read()).hexdigest()
+
+	return result.returncode, hashlib.sha256(result.stdout).hexdigest(), result.stdout.count(b"token: "), ir
+
+
+
+def main():
+	if len(sys.argv) < 2:
+		print("usage: python3 tests/tokenizer_chunks.py path/to/hawk [seed]")
+		return 2
+
+	hawk = os.path.abspath(sys.argv[1])
+	seed = int(sys.argv[2]) if len(sys.argv) > 2 else 1
+	rng = random.Random(seed)
+
+	failures = 0
+
+	with tempfile.TemporaryDirectory() as root:
+		for name, source in make_cases(rng):
+			path = os.path.join(root, "chunks.hawk")
+			source.write(path)
+
+			one_thread = run(hawk, path, 1)
+			chunked = run(hawk, path, 4)
+
+			if one_thread != chunked:
+				failures += 1
+				print(f"{name}: lexing on one thread and in chunks differ")
+				print(f"\tone thread: exit code {one_thread[0]}, {one_thread[2]} tokens, IR {one_thread[3]}")
+				print(f"\tin chunks:  exit code {chunked[0]}, {chunked[2]} tokens, IR {chunked[3]}")
+			else:
+				print(f"{name}: same ({source.size >> 20}MB, exit code {chunked[0]}, {chunked[2]} tokens)")
+
+
+	if failures != 0:
+		print("FAILED")
+		return 1
+
+	print("passed")
+	return 0
+
+
+
+if __name__ == "__main__":
+	sys.exit(main())